@@ -0,0 +1,314 @@
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ * pfsformat - write an empty PFS volume to an image file or block device
+ * on a Linux host.  See README.txt for the layout and options.
+ */
+#include <SdBaseFile.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+//------------------------------------------------------------------------------
+// blocks written by each pwrite(), the offset of each is a multiple of it
+uint32_t const CHUNK_BLOCKS = 2048;
+// data area alignment for volumes of at least ALIGN_MIN_BLOCKS, the usual
+// SD allocation unit of 4 MB
+uint32_t const ALIGN_BLOCKS = 8192;
+uint32_t const ALIGN_MIN_BLOCKS = 524288;
+
+// volume layout, all sizes in 512 byte blocks
+struct PfsLayout_t {
+  uint32_t totalBlocks;       // blocks in the volume
+  uint8_t  blocksPerCluster;  // cluster size
+  uint8_t  pfsCount;          // copies of the table
+  uint32_t sectorsPerFat;     // blocks in each copy of the table
+  uint16_t spareBlocks;       // unused blocks after the tables
+  uint16_t journalBlocks;     // metadata journal, zero if none
+  uint32_t dataStart;         // first block of cluster 2, the root
+  uint32_t clusterCount;      // clusters in the data area
+};
+//------------------------------------------------------------------------------
+static void usage() {
+  fprintf(stderr,
+    "usage: pfsformat [options] path\n"
+    "  -c n   blocks per cluster, 1 to 128, default from capacity\n"
+    "  -a n   align the data area to n blocks, default 8192 from 256 MB\n"
+    "  -t n   copies of the PFS table, 1 or 2, default 2\n"
+    "  -j n   metadata journal blocks, default 0, %u or more to\n"
+    "         journal every transaction of this build\n"
+    "  -l s   volume label, up to 11 characters\n"
+    "  -s n   size of a new or resized image file in MB\n"
+    "  -e     erase (discard) the whole volume first\n"
+    "  -n     do not mount the volume to verify it\n",
+    JOURNAL_MAX_BLOCKS);
+  exit(2);
+}
+//------------------------------------------------------------------------------
+static void fatal(const char* msg, const char* path) {
+  fprintf(stderr, "pfsformat: %s: %s", path, msg);
+  if (errno) fprintf(stderr, ": %s", strerror(errno));
+  fprintf(stderr, "\n");
+  exit(1);
+}
+//------------------------------------------------------------------------------
+// Cluster size that keeps the table small and clusters at most a few per
+// card page for small volumes, like the FAT32 defaults.
+static uint8_t clusterBlocks(uint32_t totalBlocks) {
+  if (totalBlocks < 131072) return 2;       // < 64 MB, 1 KB
+  if (totalBlocks < 524288) return 4;       // < 256 MB, 2 KB
+  if (totalBlocks < 16777216) return 8;     // < 8 GB, 4 KB
+  if (totalBlocks < 33554432) return 16;    // < 16 GB, 8 KB
+  if (totalBlocks < 67108864) return 32;    // < 32 GB, 16 KB
+  return 64;                                // 32 KB
+}
+//------------------------------------------------------------------------------
+// Size the table for the clusters that follow it and move the data area
+// to a multiple of align by growing the table.  Return false if the
+// volume has no room for the root or the table is too large for
+// PFS_boot.
+static bool layout(PfsLayout_t* v, uint32_t align) {
+  uint32_t pad;
+  v->sectorsPerFat = 1;
+  // fewer clusters fit as the table grows, so this stops
+  while (true) {
+    v->dataStart = 2 + v->pfsCount*v->sectorsPerFat + v->journalBlocks;
+    if (v->dataStart >= v->totalBlocks) return false;
+    v->clusterCount = (v->totalBlocks - v->dataStart)/v->blocksPerCluster;
+    uint32_t need = (v->clusterCount + 2 + 127)/128;
+    if (need <= v->sectorsPerFat) break;
+    v->sectorsPerFat = need;
+  }
+  // the part of the padding the tables can't take evenly is spare
+  pad = align > 1 ? (align - v->dataStart % align) % align : 0;
+  v->sectorsPerFat += pad/v->pfsCount;
+  v->spareBlocks = pad % v->pfsCount;
+  v->dataStart += pad;
+  if (v->dataStart >= v->totalBlocks) return false;
+  v->clusterCount = (v->totalBlocks - v->dataStart)/v->blocksPerCluster;
+  return v->clusterCount >= 2 && v->sectorsPerFat <= 0XFFFF;
+}
+//------------------------------------------------------------------------------
+// Fill chunk, blocks [first, first + count) of the volume.
+static void fillChunk(uint8_t* chunk, uint32_t first, uint32_t count,
+                      const PfsLayout_t* v, const char* label) {
+  memset(chunk, 0, 512*count);
+  if (first == 0) {
+    pfs_boot_t* pbs = reinterpret_cast<pfs_boot_t*>(chunk);
+    pbs->bytesPerSector = 512;
+    pbs->sectorsPerCluster = v->blocksPerCluster;
+    pbs->totalSectors = v->totalBlocks;
+    pbs->pfsRootCluster = 2;
+    // each entry of the root entry count is 32 bytes before the data
+    pbs->rootDirEntryCount = 16*v->spareBlocks;
+    memset(pbs->volumeLabel, ' ', sizeof(pbs->volumeLabel));
+    memcpy(pbs->volumeLabel, label, strlen(label));
+    memcpy(pbs->fileSystemType, "PFS     ", sizeof(pbs->fileSystemType));
+    pbs->pfsInfo = 1;
+    pbs->bootSectorSig0 = BOOTSIG0;
+    pbs->bootSectorSig1 = BOOTSIG1;
+    pbs->sectorsPerFat = v->sectorsPerFat;
+    pbs->pfsCount = v->pfsCount;
+    pbs->journalBlocks = v->journalBlocks;
+
+    pfs_info_t* fsi = reinterpret_cast<pfs_info_t*>(chunk + 512);
+    fsi->leadSignature = FSINFO_LEAD_SIG;
+    fsi->structSignature = FSINFO_STRUCT_SIG;
+    // the root has the first cluster
+    fsi->freeCount = v->clusterCount - 1;
+    fsi->nextFree = 3;
+    fsi->tailSignature[2] = BOOTSIG0;
+    fsi->tailSignature[3] = BOOTSIG1;
+  }
+  // reserved entries and the root in the first block of each table
+  for (uint8_t k = 0; k < v->pfsCount; k++) {
+    uint32_t b = 2 + k*v->sectorsPerFat;
+    if (b < first || b >= (first + count)) continue;
+    uint32_t* pfs = reinterpret_cast<uint32_t*>(chunk + 512*(b - first));
+    pfs[0] = 0X0FFFFFF8;
+    pfs[1] = 0X0FFFFFFF;
+    pfs[2] = 0X0FFFFFFF;
+  }
+}
+//------------------------------------------------------------------------------
+// Discard the whole volume.  A card may read erased blocks as ones, the
+// metadata is written after this.
+static bool eraseVolume(int fd, const struct stat* st, uint64_t bytes) {
+  if (S_ISBLK(st->st_mode)) {
+    uint64_t range[2] = {0, bytes};
+    return ioctl(fd, BLKDISCARD, range) == 0;
+  }
+  return fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                   0, bytes) == 0;
+}
+//------------------------------------------------------------------------------
+// Mount the volume with the library and check its size and free count.
+static bool verify(const char* path, const PfsLayout_t* v) {
+  Sd2Card card;
+  SdVolume vol;
+  SdBaseFile root;
+  if (!card.init(path) || !vol.init(&card) || !root.openRoot(&vol)) {
+    return false;
+  }
+  return vol.clusterCount() == v->clusterCount
+         && vol.dataStartBlock() == v->dataStart
+         && vol.freeClusterCount() == (int32_t)(v->clusterCount - 1)
+         && root.fileSize() == 512UL*v->blocksPerCluster;
+}
+//------------------------------------------------------------------------------
+static double seconds(const struct timespec* t0) {
+  struct timespec t1;
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec)*1e-9;
+}
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+  PfsLayout_t v;
+  uint32_t align = 0;
+  uint32_t sizeMB = 0;
+  bool autoCluster;
+  bool erase = false;
+  bool check = true;
+  char label[12] = "NO NAME";
+  struct stat st;
+  struct timespec t0;
+  uint64_t bytes;
+  uint8_t* chunk;
+  int opt;
+  int fd;
+
+  memset(&v, 0, sizeof(v));
+  v.pfsCount = 2;
+  while ((opt = getopt(argc, argv, "a:c:ej:l:ns:t:")) != -1) {
+    switch (opt) {
+      case 'a':
+        align = strtoul(optarg, 0, 0);
+        break;
+      case 'c':
+        v.blocksPerCluster = strtoul(optarg, 0, 0);
+        // the volume requires a power of two
+        if (v.blocksPerCluster == 0
+          || (v.blocksPerCluster & (v.blocksPerCluster - 1))) {
+          usage();
+        }
+        break;
+      case 'e':
+        erase = true;
+        break;
+      case 'j':
+        v.journalBlocks = strtoul(optarg, 0, 0);
+        break;
+      case 'l':
+        if (strlen(optarg) > 11) usage();
+        strcpy(label, optarg);
+        for (char* p = label; *p; p++) {
+          if (*p >= 'a' && *p <= 'z') *p += 'A' - 'a';
+        }
+        break;
+      case 'n':
+        check = false;
+        break;
+      case 's':
+        sizeMB = strtoul(optarg, 0, 0);
+        break;
+      case 't':
+        v.pfsCount = strtoul(optarg, 0, 0);
+        if (v.pfsCount < 1 || v.pfsCount > 2) usage();
+        break;
+      default:
+        usage();
+    }
+  }
+  if (optind != argc - 1) usage();
+  const char* path = argv[optind];
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+
+  errno = 0;
+  fd = open(path, O_RDWR | (sizeMB ? O_CREAT : 0), 0644);
+  if (fd < 0 || fstat(fd, &st)) fatal("can't open", path);
+  if (S_ISBLK(st.st_mode)) {
+    if (ioctl(fd, BLKGETSIZE64, &bytes)) fatal("can't get size", path);
+  } else {
+    if (sizeMB && ftruncate(fd, (off_t)sizeMB << 20)) {
+      fatal("can't set size", path);
+    }
+    bytes = sizeMB ? (uint64_t)sizeMB << 20 : (uint64_t)st.st_size;
+  }
+  errno = 0;
+  // totalSectors is 32 bits
+  if ((bytes >> 9) > 0XFFFFFFFF) fatal("larger than 2 TB", path);
+  v.totalBlocks = bytes >> 9;
+  autoCluster = v.blocksPerCluster == 0;
+  if (autoCluster) v.blocksPerCluster = clusterBlocks(v.totalBlocks);
+  // larger clusters if the table would not fit
+  while (true) {
+    uint32_t a = align ? align : v.totalBlocks >= ALIGN_MIN_BLOCKS
+                 ? ALIGN_BLOCKS : v.blocksPerCluster;
+    if (layout(&v, a)) break;
+    if (!autoCluster || v.blocksPerCluster == 128
+      || v.sectorsPerFat <= 0XFFFF) {
+      fatal("too small for the layout", path);
+    }
+    v.blocksPerCluster <<= 1;
+  }
+
+  if (erase) {
+    errno = 0;
+    if (!eraseVolume(fd, &st, 512ULL*v.totalBlocks)) {
+      fprintf(stderr, "pfsformat: %s: erase failed: %s, continuing\n",
+              path, strerror(errno));
+    }
+  }
+  // blocks before the data area and the root cluster, written in chunks
+  // at multiples of CHUNK_BLOCKS
+  chunk = reinterpret_cast<uint8_t*>(aligned_alloc(4096, 512*CHUNK_BLOCKS));
+  if (!chunk) fatal("no memory", path);
+  uint32_t end = v.dataStart + v.blocksPerCluster;
+  for (uint32_t b = 0; b < end; b += CHUNK_BLOCKS) {
+    uint32_t n = (end - b) < CHUNK_BLOCKS ? end - b : CHUNK_BLOCKS;
+    fillChunk(chunk, b, n, &v, label);
+    errno = 0;
+    if (pwrite(fd, chunk, 512*n, 512*(off_t)b) != (ssize_t)(512*n)) {
+      fatal("write failed", path);
+    }
+  }
+  free(chunk);
+  errno = 0;
+  if (fsync(fd) || close(fd)) fatal("sync failed", path);
+
+  printf("%s: %u blocks, %u clusters of %u bytes\n", path, v.totalBlocks,
+         v.clusterCount, 512*v.blocksPerCluster);
+  printf("  %u table%s of %u blocks, journal %u blocks, data at block %u\n",
+         v.pfsCount, v.pfsCount > 1 ? "s" : "", v.sectorsPerFat,
+         v.journalBlocks, v.dataStart);
+  if (check) {
+    errno = 0;
+    if (!verify(path, &v)) fatal("mount check failed", path);
+    printf("  mounted and verified\n");
+  }
+  printf("  %.3f seconds\n", seconds(&t0));
+  return 0;
+}
@@ -0,0 +1,209 @@
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ * pfsregress - regression checks of the library on a scratch PFS image.
+ * See README.txt.
+ */
+#include <SdBaseFile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+//------------------------------------------------------------------------------
+// bytes written by each write() of a test
+uint16_t const CHUNK_SIZE = 4000;
+
+// image of the volume
+static const char* path;
+static Sd2Card card;
+static SdVolume vol;
+static SdBaseFile root;
+//------------------------------------------------------------------------------
+// Byte at offset of the file with id.
+static uint8_t pattern(uint8_t id, uint32_t offset) {
+  return id*31 + offset*7 + (offset >> 9);
+}
+//------------------------------------------------------------------------------
+static bool mount() {
+  root.close();
+  return card.init(path) && vol.init(&card) && root.openRoot(&vol);
+}
+//------------------------------------------------------------------------------
+// Write size bytes of the pattern of id at the current position of file
+// with write() calls of up to chunk bytes.
+static bool fill(SdBaseFile* file, uint8_t id, uint32_t size,
+                 uint32_t chunk = CHUNK_SIZE) {
+  uint8_t* buf = reinterpret_cast<uint8_t*>(malloc(chunk));
+  bool rtn = buf != 0;
+  while (rtn && size) {
+    uint32_t offset = file->curPosition();
+    uint32_t n = size < chunk ? size : chunk;
+    for (uint32_t i = 0; i < n; i++) buf[i] = pattern(id, offset + i);
+    rtn = file->write(buf, n) == (int)n;
+    size -= n;
+  }
+  free(buf);
+  return rtn;
+}
+//------------------------------------------------------------------------------
+// Check that name holds size bytes of the pattern of id.
+static bool verify(const char* name, uint8_t id, uint32_t size) {
+  uint8_t buf[CHUNK_SIZE];
+  uint32_t offset = 0;
+  SdBaseFile file;
+  int n;
+  if (!file.open(&root, name, O_READ) || file.fileSize() != size) {
+    printf("  %s: can't open or wrong size\n", name);
+    return false;
+  }
+  while ((n = file.read(buf, CHUNK_SIZE)) > 0) {
+    for (int i = 0; i < n; i++, offset++) {
+      if (buf[i] != pattern(id, offset)) {
+        printf("  %s: mismatch at offset %u\n", name, offset);
+        return false;
+      }
+    }
+  }
+  return n == 0 && offset == size;
+}
+//------------------------------------------------------------------------------
+// A contiguous file extended past its allocation by one write() while the
+// next cluster belongs to another file must stop being contiguous, also
+// after a mount.
+static bool contiguousExtend() {
+  uint32_t clusterSize = 512UL*vol.blocksPerCluster();
+  uint32_t size = 8*clusterSize;
+  uint32_t extra = 3*clusterSize - 100;
+  SdBaseFile a;
+  SdBaseFile b;
+  bool rtn;
+  if (!a.createContiguous(&root, "CONTIG.BIN", size)) return false;
+  // the neighbour takes the cluster after the allocation
+  if (!b.open(&root, "NEIGHBOR.BIN", O_CREAT | O_RDWR)
+    || !fill(&b, 2, clusterSize) || !b.close()) {
+    return false;
+  }
+  // write the allocation, then the new clusters in one call
+  if (!fill(&a, 1, size) || !fill(&a, 1, extra, extra)) return false;
+  if (a.isContiguous()) {
+    printf("  CONTIG.BIN: still contiguous after a fragment was added\n");
+    return false;
+  }
+  if (!a.close()) return false;
+  rtn = verify("CONTIG.BIN", 1, size + extra)
+        && verify("NEIGHBOR.BIN", 2, clusterSize);
+  if (!mount()) return false;
+  rtn = rtn && verify("CONTIG.BIN", 1, size + extra)
+        && verify("NEIGHBOR.BIN", 2, clusterSize);
+  return SdBaseFile::remove(&root, "CONTIG.BIN")
+         && SdBaseFile::remove(&root, "NEIGHBOR.BIN") && rtn;
+}
+//------------------------------------------------------------------------------
+// Create an empty file in the root.
+static bool touch(const char* name) {
+  SdBaseFile file;
+  return file.open(&root, name, O_CREAT | O_RDWR) && file.close();
+}
+//------------------------------------------------------------------------------
+#if DIR_HASH_SIZE
+// Creates that follow removes in the hashed directory must use the freed
+// entries, a rotation of files does not grow the directory.
+static bool dirRotate() {
+  uint32_t rotations = 2*512UL*vol.blocksPerCluster()/32;
+  uint32_t size;
+  char name[13];
+  bool rtn = true;
+  for (uint32_t i = 0; i < 4; i++) {
+    sprintf(name, "ROT%u.TMP", i);
+    if (!touch(name)) return false;
+  }
+  size = root.fileSize();
+  for (uint32_t i = 4; rtn && i < (rotations + 4); i++) {
+    sprintf(name, "ROT%u.TMP", i);
+    rtn = touch(name);
+    sprintf(name, "ROT%u.TMP", i - 4);
+    rtn = rtn && SdBaseFile::remove(&root, name);
+  }
+  if (rtn && root.fileSize() != size) {
+    printf("  root grew from %u to %u bytes\n", size, root.fileSize());
+    rtn = false;
+  }
+  for (uint32_t i = rotations; i < (rotations + 4); i++) {
+    sprintf(name, "ROT%u.TMP", i);
+    SdBaseFile::remove(&root, name);
+  }
+  return rtn;
+}
+//------------------------------------------------------------------------------
+// A directory with more names than the hash holds is searched linearly,
+// an open must not hash it again.
+static bool dirOverflow() {
+  uint32_t count = (DIR_HASH_SIZE/4)*3 + 16;
+  uint32_t reads;
+  char name[13];
+  SdBaseFile file;
+  bool rtn = true;
+  for (uint32_t i = 0; rtn && i < count; i++) {
+    sprintf(name, "B%u.TMP", i);
+    rtn = touch(name);
+  }
+  // the first open may hash the directory
+  rtn = rtn && file.open(&root, name, O_READ) && file.close();
+  reads = card.stats().blocksRead;
+  rtn = rtn && file.open(&root, name, O_READ) && file.close();
+  reads = card.stats().blocksRead - reads;
+  if (rtn && reads > 3*root.fileSize()/1024) {
+    printf("  open read %u blocks of a %u block directory\n", reads,
+           root.fileSize()/512);
+    rtn = false;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    sprintf(name, "B%u.TMP", i);
+    SdBaseFile::remove(&root, name);
+  }
+  return rtn;
+}
+#endif  // DIR_HASH_SIZE
+//------------------------------------------------------------------------------
+struct PfsTest_t {
+  const char* name;
+  bool (*run)();
+};
+static const PfsTest_t tests[] = {
+  {"contiguous file extended into a fragment", contiguousExtend},
+#if DIR_HASH_SIZE
+  {"removed names free their directory entries", dirRotate},
+  {"directory too large to hash", dirOverflow},
+#endif  // DIR_HASH_SIZE
+};
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+  int fails = 0;
+  if (argc != 2) {
+    fprintf(stderr, "usage: pfsregress path\n");
+    return 2;
+  }
+  path = argv[1];
+  for (size_t i = 0; i < sizeof(tests)/sizeof(tests[0]); i++) {
+    bool ok = mount() && tests[i].run();
+    printf("%s: %s\n", ok ? "ok  " : "FAIL", tests[i].name);
+    if (!ok) fails++;
+  }
+  return fails ? 1 : 0;
+}
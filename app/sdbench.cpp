@@ -0,0 +1,165 @@
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ * sdbench - time block and file writes on a PFS image with the latency
+ * model of the host Sd2Card.  See README.txt.
+ */
+#include <SdBaseFile.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+//------------------------------------------------------------------------------
+// file written by the benchmark, removed at the end
+const char BENCH_FILE[] = "BENCH.DAT";
+// bytes written by each file write()
+uint16_t const WRITE_SIZE = 4096;
+
+// counters at the start of a test
+static SdHostStats start;
+//------------------------------------------------------------------------------
+static void usage() {
+  fprintf(stderr,
+    "usage: sdbench [options] path\n"
+    "  -k n   kilobytes to write, default 256\n"
+    "  -m n   command overhead in ns, default 20000\n"
+    "  -b n   block transfer time in ns, default 520000\n"
+    "  -p n   program time per block in ns, default 50000\n"
+    "  -u n   busy time per write command in ns, default 1500000\n");
+  exit(2);
+}
+//------------------------------------------------------------------------------
+static void fatal(const char* msg, Sd2Card* card) {
+  fprintf(stderr, "sdbench: %s, card error 0X%X\n", msg, card->errorCode());
+  exit(1);
+}
+//------------------------------------------------------------------------------
+static void begin(Sd2Card* card) {
+  start = card->stats();
+}
+//------------------------------------------------------------------------------
+// Print the model time and counters since begin().
+static void report(const char* name, Sd2Card* card, uint32_t blocks) {
+  const SdHostStats& s = card->stats();
+  double ms = (s.modelNanos - start.modelNanos)*1e-6;
+  printf("%-26s %9.1f ms %8.1f KB/s %6u cmds %6u wr %6u rd\n", name, ms,
+         ms > 0 ? blocks/(2*ms)*1000 : 0, s.commands - start.commands,
+         s.blocksWritten - start.blocksWritten,
+         s.blocksRead - start.blocksRead);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+  SdHostLatency latency = {20000, 520000, 50000, 1500000, 5000000};
+  uint32_t kb = 256;
+  uint32_t bgn, end, blocks;
+  Sd2Card card;
+  SdVolume vol;
+  SdBaseFile root;
+  SdBaseFile file;
+  uint8_t* buf;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "b:k:m:p:u:")) != -1) {
+    switch (opt) {
+      case 'b':
+        latency.blockNanos = strtoul(optarg, 0, 0);
+        break;
+      case 'k':
+        kb = strtoul(optarg, 0, 0);
+        if (kb == 0) usage();
+        break;
+      case 'm':
+        latency.commandNanos = strtoul(optarg, 0, 0);
+        break;
+      case 'p':
+        latency.programNanos = strtoul(optarg, 0, 0);
+        break;
+      case 'u':
+        latency.busyNanos = strtoul(optarg, 0, 0);
+        break;
+      default:
+        usage();
+    }
+  }
+  if (optind != argc - 1) usage();
+  blocks = 2*kb;
+  buf = reinterpret_cast<uint8_t*>(malloc(512*blocks));
+  if (!buf) fatal("no memory", &card);
+  for (uint32_t i = 0; i < 512*blocks; i++) buf[i] = i*7;
+
+  if (!card.init(argv[optind])) fatal("can't open the image", &card);
+  if (!vol.init(&card) || !root.openRoot(&vol)) {
+    fatal("can't mount the volume", &card);
+  }
+  // the raw tests write the blocks of a contiguous file
+  if (!file.createContiguous(&root, BENCH_FILE, 512*blocks)
+    || !file.contiguousRange(&bgn, &end)) {
+    fatal("can't create BENCH.DAT", &card);
+  }
+  card.setLatency(latency);
+  printf("%u KB, blocks %u to %u\n", kb, bgn, end);
+
+  begin(&card);
+  for (uint32_t b = 0; b < blocks; b++) {
+    if (!card.writeBlock(bgn + b, buf + 512*b)) fatal("CMD24 failed", &card);
+  }
+  report("CMD24 each block", &card, blocks);
+
+  begin(&card);
+  if (!card.writeStart(bgn, 0)) fatal("CMD25 failed", &card);
+  for (uint32_t b = 0; b < blocks; b++) {
+    if (!card.writeData(buf + 512*b)) fatal("CMD25 failed", &card);
+  }
+  if (!card.writeStop()) fatal("CMD25 failed", &card);
+  report("CMD25", &card, blocks);
+
+  begin(&card);
+  if (!card.writeStart(bgn, blocks)) fatal("CMD25 failed", &card);
+  for (uint32_t b = 0; b < blocks; b++) {
+    if (!card.writeData(buf + 512*b)) fatal("CMD25 failed", &card);
+  }
+  if (!card.writeStop()) fatal("CMD25 failed", &card);
+  report("CMD25 with pre-erase", &card, blocks);
+
+  begin(&card);
+  file.rewind();
+  for (uint32_t i = 0; i < 512*blocks; i += WRITE_SIZE) {
+    uint32_t n = 512*blocks - i < WRITE_SIZE ? 512*blocks - i : WRITE_SIZE;
+    if (file.write(buf + i, n) != (int)n) fatal("write failed", &card);
+  }
+  if (!file.sync()) fatal("sync failed", &card);
+  report("file write()", &card, blocks);
+
+  begin(&card);
+  file.rewind();
+  for (uint32_t i = 0; i < 512*blocks; i += WRITE_SIZE) {
+    uint8_t rb[WRITE_SIZE];
+    uint32_t n = 512*blocks - i < WRITE_SIZE ? 512*blocks - i : WRITE_SIZE;
+    if (file.read(rb, n) != (int)n || memcmp(rb, buf + i, n)) {
+      fatal("read failed", &card);
+    }
+  }
+  report("file read()", &card, blocks);
+
+  card.setLatency(SdHostLatency());
+  if (!file.remove()) fatal("can't remove BENCH.DAT", &card);
+  free(buf);
+  return 0;
+}
@@ -1,685 +1,1062 @@
-/* Arduino PFS Library
- * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
- *
- * This file is part of the Arduino PFS Library
- *
- * This Library is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This Library is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with the Arduino PFS Library.  If not, see
- * <http://www.gnu.org/licenses/>.
- */
-/*
- *Creditos: https://github.com/frasermac/sdfatlib
- */
-
-#include <Sd2Card.h>
-// debug trace macro
-#define SD_TRACE(m, b) Serial.print(m);Serial.println(b);
-
-// SPI functions
-//==============================================================================
-#if USE_ARDUINO_SPI_LIBRARY
-#include <SPI.h>
-//------------------------------------------------------------------------------
-static void spiBegin() {
-  SPI.begin();
-}
-//------------------------------------------------------------------------------
-static void spiInit(uint8_t spiRate) {
-  SPI.setBitOrder(MSBFIRST);
-  SPI.setDataMode(SPI_MODE0);
-  int v;
-#ifdef SPI_CLOCK_DIV128
-  switch (spiRate/2) {
-    case 0: v = SPI_CLOCK_DIV2; break;
-    case 1: v = SPI_CLOCK_DIV4; break;
-    case 2: v = SPI_CLOCK_DIV8; break;
-    case 3: v = SPI_CLOCK_DIV16; break;
-    case 4: v = SPI_CLOCK_DIV32; break;
-    case 5: v = SPI_CLOCK_DIV64; break;
-    default: v = SPI_CLOCK_DIV128; break;
-  }
-#else  // SPI_CLOCK_DIV128
-  if (spiRate > 13) {
-    v = 255;
-  } else {
-    v = (2 | (spiRate & 1)) << (spiRate/2);
-  }
-#endif  // SPI_CLOCK_DIV128
-  SPI.setClockDivider(v);
-}
-//------------------------------------------------------------------------------
-/** SPI receive a byte */
-static  uint8_t spiRec() {
-  return SPI.transfer(0XFF);
-}
-//------------------------------------------------------------------------------
-/** SPI receive multiple bytes */
-static uint8_t spiRec(uint8_t* buf, size_t len) {
-  for (size_t i = 0; i < len; i++) {
-    buf[i] = SPI.transfer(0XFF);
-  }
-  return 0;
-}
-//------------------------------------------------------------------------------
-/** SPI send a byte */
-static void spiSend(uint8_t b) {
-  SPI.transfer(b);
-}
-//------------------------------------------------------------------------------
-/** SPI send multiple bytes */
-static void spiSend(const uint8_t* buf, size_t len) {
-  for (size_t i = 0; i < len; i++) {
-    SPI.transfer(buf[i]);
-  }
-}
-#else
-#if (SPR0 != 0 || SPR1 != 1)
-#error unexpected SPCR bits
-#endif  
-//------------------------------------------------------------------------------
-/**
- * initialize SPI pins
- */
-static void spiBegin() {
-  // set SS high - may be chip select for another SPI device
-  digitalWrite(SS, HIGH);
-  // SS must be in output mode even it is not chip select
-  pinMode(SS, OUTPUT);
-  pinMode(MISO, INPUT);
-  pinMode(MOSI, OUTPUT);
-  pinMode(SCK, OUTPUT);
-}
-//------------------------------------------------------------------------------
-/**
- * Initialize hardware SPI
- * Set SCK rate to F_CPU/pow(2, 1 + spiRate) for spiRate [0,6]
- */
-static void spiInit(uint8_t spiRate) {
-  spiRate = spiRate > 12 ? 6 : spiRate/2;
-  // See avr processor documentation
-  SPCR = (1 << SPE) | (1 << MSTR) | (spiRate >> 1);
-  SPSR = spiRate & 1 || spiRate == 6 ? 0 : 1 << SPI2X;
-}
-//------------------------------------------------------------------------------
-/** SPI receive a byte */
-static  uint8_t spiRec() {
-  SPDR = 0XFF;
-  while (!(SPSR & (1 << SPIF)));
-  return SPDR;
-}
-//------------------------------------------------------------------------------
-/** SPI receive multiple bytes */
-static uint8_t spiRec(uint8_t* buf, size_t n) {
-  if (n-- == 0) return 0;
-  SPDR = 0XFF;
-  for (size_t i = 0; i < n; i++) {
-    while (!(SPSR & (1 << SPIF)));
-    uint8_t b = SPDR;
-    SPDR = 0XFF;
-    buf[i] = b;
-  }
-  while (!(SPSR & (1 << SPIF)));
-  buf[n] = SPDR;
-  return 0;
-}
-//------------------------------------------------------------------------------
-/** SPI send a byte */
-static void spiSend(uint8_t b) {
-  SPDR = b;
-  while (!(SPSR & (1 << SPIF)));
-}
-//------------------------------------------------------------------------------
-static void spiSend(const uint8_t* buf , size_t n) {
-  if (n == 0) return;
-  SPDR = buf[0];
-  if (n > 1) {
-    uint8_t b = buf[1];
-    size_t i = 2;
-    while (1) {
-      while (!(SPSR & (1 << SPIF)));
-      SPDR = b;
-      if (i == n) break;
-      b = buf[i++];
-    }
-  }
-  while (!(SPSR & (1 << SPIF)));
-}
-#endif  // USE_ARDUINO_SPI_LIBRARY
-//==============================================================================
-#if USE_SD_CRC
-static uint8_t CRC7(const uint8_t* data, uint8_t n) {
-  uint8_t crc = 0;
-  for (uint8_t i = 0; i < n; i++) {
-    uint8_t d = data[i];
-    for (uint8_t j = 0; j < 8; j++) {
-      crc <<= 1;
-      if ((d & 0x80) ^ (crc & 0x80)) crc ^= 0x09;
-      d <<= 1;
-    }
-  }
-  return (crc << 1) | 1;
-}
-//------------------------------------------------------------------------------
-#if USE_SD_CRC == 1
-// slower CRC-CCITT
-// uses the x^16,x^12,x^5,x^1 polynomial.
-static uint16_t CRC_CCITT(const uint8_t *data, size_t n) {
-  uint16_t crc = 0;
-  for (size_t i = 0; i < n; i++) {
-    crc = (uint8_t)(crc >> 8) | (crc << 8);
-    crc ^= data[i];
-    crc ^= (uint8_t)(crc & 0xff) >> 4;
-    crc ^= crc << 12;
-    crc ^= (crc & 0xff) << 5;
-  }
-  return crc;
-}
-#endif  // CRC_CCITT
-#endif  // USE_SD_CRC
-static uint8_t CRC7(const uint8_t* data, uint8_t n) {
-  uint8_t crc = 0;
-  for (uint8_t i = 0; i < n; i++) {
-    uint8_t d = data[i];
-    for (uint8_t j = 0; j < 8; j++) {
-      crc <<= 1;
-      if ((d & 0x80) ^ (crc & 0x80)) crc ^= 0x09;
-      d <<= 1;
-    }
-  }
-  return (crc << 1) | 1;
-}
-//==============================================================================
-// Sd2Card member functions
-//------------------------------------------------------------------------------
-// send command and return error code.  Return zero for OK
-uint8_t Sd2Card::cardCommand(uint8_t cmd, uint32_t arg) {
-  // select card
-  chipSelectLow();
-  // wait up to 300 ms if busy
- // waitNotBusy(300);
-  // send command
-  spiSend(cmd | 0x40);
-  // send argument
-   uint8_t off[4] = {24,16,8,0};
-  for (int x = 0; x <4; x++) spiSend(arg >> off[x]);
-
-  // send CRC
-  uint8_t crc = 0XFF;
-  if (cmd == CMD0) crc = 0X95;  // correct crc for CMD0 with arg 0
-  if (cmd == CMD8) crc = 0X87;  // correct crc for CMD8 with arg 0X1AA
-  spiSend(crc);
-  // wait for response
-  for (uint8_t i = 0; ((status_ = spiRec()) & 0X80) && i != 0XFF; i++);
-  return status_;
-}
-//------------------------------------------------------------------------------
-void Sd2Card::chipSelectHigh() {
-  digitalWrite(chipSelectPin_, HIGH);
-  // insure MISO goes high impedance
-  spiSend(0XFF);
-}
-//------------------------------------------------------------------------------
-void Sd2Card::chipSelectLow() {
-  spiInit(spiRate_);
-  digitalWrite(chipSelectPin_, LOW);
-}
-/**
- * Determine the size of an SD flash memory card.
- *
- * \return The number of 512 byte data blocks in the card
- *         or zero if an error occurs.
- */
-uint32_t Sd2Card::cardSize() {
-  csd_t csd;
-  if (!readCSD(&csd)) return 0;
-  if (csd.v1.csd_ver == 0) {
-    uint8_t read_bl_len = csd.v1.read_bl_len;
-    uint16_t c_size = (csd.v1.c_size_high << 10)
-                      | (csd.v1.c_size_mid << 2) | csd.v1.c_size_low;
-    uint8_t c_size_mult = (csd.v1.c_size_mult_high << 1)
-                          | csd.v1.c_size_mult_low;
-    return (uint32_t)(c_size + 1) << (c_size_mult + read_bl_len - 7);
-  } else if (csd.v2.csd_ver == 1) {
-    uint32_t c_size = 0X10000L * csd.v2.c_size_high + 0X100L
-                      * (uint32_t)csd.v2.c_size_mid + csd.v2.c_size_low;
-    return (c_size + 1) << 10;
-  } else {
-    error(SD_CARD_ERROR_BAD_CSD);
-    return 0;
-  }
-}
-//------------------------------------------------------------------------------
-/** Erase a range of blocks.
- *
- * \param[in] firstBlock The address of the first block in the range.
- * \param[in] lastBlock The address of the last block in the range.
- *
- * \note This function requests the SD card to do a flash erase for a
- * range of blocks.  The data on the card after an erase operation is
- * either 0 or 1, depends on the card vendor.  The card must support
- * single block erase.
- *
- * \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::erase(uint32_t firstBlock, uint32_t lastBlock) {
-  csd_t csd;
-  if (!readCSD(&csd)) goto fail;
-  // check for single block erase
-  if (!csd.v1.erase_blk_en) {
-    // erase size mask
-    uint8_t m = (csd.v1.sector_size_high << 1) | csd.v1.sector_size_low;
-    if ((firstBlock & m) != 0 || ((lastBlock + 1) & m) != 0) {
-      // error card can't erase specified area
-      error(SD_CARD_ERROR_ERASE_SINGLE_BLOCK);
-      goto fail;
-    }
-  }
-  if (type_ != SD_CARD_TYPE_SDHC) {
-    firstBlock <<= 9;
-    lastBlock <<= 9;
-  }
-  if (cardCommand(CMD32, firstBlock)
-    || cardCommand(CMD33, lastBlock)
-    || cardCommand(CMD38, 0)) {
-      error(SD_CARD_ERROR_ERASE);
-      goto fail;
-  }
-  if (!waitNotBusy(SD_ERASE_TIMEOUT)) {
-    error(SD_CARD_ERROR_ERASE_TIMEOUT);
-    goto fail;
-  }
-  chipSelectHigh();
-  return true;
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/** Determine if card supports single block erase.
- *
- * \return The value one, true, is returned if single block erase is supported.
- * The value zero, false, is returned if single block erase is not supported.
- */
-bool Sd2Card::eraseSingleBlockEnable() {
-  csd_t csd;
-  return readCSD(&csd) ? csd.v1.erase_blk_en : false;
-}
-//------------------------------------------------------------------------------
-/**
- * Initialize an SD flash memory card.
- *
- * \param[in] sckRateID SPI clock rate selector. See setSckRate().
- * \param[in] chipSelectPin SD chip select pin number.
- *
- * \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.  The reason for failure
- * can be determined by calling errorCode() and errorData().
- */
-bool Sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin) {
-  errorCode_ = type_ = 0;
-  chipSelectPin_ = chipSelectPin;
-  // 16-bit init start time allows over a minute
-  uint16_t t0 = (uint16_t)millis();
-  uint32_t arg;
-
-  pinMode(chipSelectPin_, OUTPUT);
-  digitalWrite(chipSelectPin_, LOW); 
-  digitalWrite(chipSelectPin_, HIGH);
-  spiBegin();
-
-  // set SCK rate for initialization commands
-  spiRate_ = SPI_SD_INIT_RATE;
-  spiInit(spiRate_);
-
-  // must supply min of 74 clock cycles with CS high.
-  for (uint8_t i = 0; i < 10; i++) spiSend(0XFF);
-
-  // command to go idle in SPI mode
-if(cardCommand(CMD0, 0) != R1_IDLE_STATE){
-  error(SD_CARD_ERROR_CMD0);
-    goto fail;
-  }
-  while (cardCommand(0X41, 0) != R1_READY_STATE) {
-    if (((uint16_t)millis() - t0) > SD_INIT_TIMEOUT) {
-      error(SD_CARD_ERROR_CMD0);
-      goto fail;
-    }
-  }
-#if USE_SD_CRC
-  if (cardCommand(CMD59, 1) != R1_IDLE_STATE) {
-    error(SD_CARD_ERROR_CMD59);
-    goto fail;
-  }
-#endif  // USE_SD_CRC
-
-  // check SD version
-   t0 = (uint16_t)millis();
- /* while (1) {
-    if (cardCommand(CMD8, 0x1AA) == (R1_ILLEGAL_COMMAND | R1_IDLE_STATE)) {
-      type(SD_CARD_TYPE_SD1);
-      break;
-    }
-    for (uint8_t i = 0; i < 4; i++) status_ = spiRec();
-    if (status_ == 0XAA) {
-      type(SD_CARD_TYPE_SD2);
-      break;
-    }
-    if (((uint16_t)millis() - t0) > SD_INIT_TIMEOUT) {
-      error(SD_CARD_ERROR_CMD8);
-      goto fail;
-    }
-  }*/
-  return true;
- fail:
-  chipSelectHigh();
-  return false;
-}
-  //------------------------------------------------------------------------------
-/**
- * Read a 512 byte block from an SD card.
- *
- * \param[in] blockNumber Logical block to be read.
- * \param[out] dst Pointer to the location that will receive the data.
-
- * \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::readBlock(uint32_t blockNumber, uint8_t* dst) {
-  SD_TRACE("RB", blockNumber);
-  // use address if not SDHC card
-  if (type()!= SD_CARD_TYPE_SDHC) blockNumber <<= 9;
-  if (cardCommand(CMD17, blockNumber)) {
-    error(SD_CARD_ERROR_CMD17);
-    goto fail;
-  }
-  return readData(dst, 512);
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/** Read one data block in a multiple block read sequence
- *
- * \param[in] dst Pointer to the location for the data to be read.
- *
- * \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::readData(uint8_t *dst) {
-  chipSelectLow();
-  return readData(dst, 512);
-}
-//------------------------------------------------------------------------------
-bool Sd2Card::readData(uint8_t* dst, size_t count) {
-  uint16_t crc;
-  // wait for start block token
-  uint16_t t0 = millis();
-  while ((status_ = spiRec()) == 0XFF) {
-    if (((uint16_t)millis() - t0) > SD_READ_TIMEOUT) {
-      error(SD_CARD_ERROR_READ_TIMEOUT);
-      goto fail;
-    }
-  }
-  if (status_ != DATA_START_BLOCK) {
-    error(SD_CARD_ERROR_READ);
-    goto fail;
-  }
-  // transfer data
-  if (status_ = spiRec(dst, count)) {
-    error(SD_CARD_ERROR_SPI_DMA);
-    goto fail;
-  }
-  // get crc
-  crc = (spiRec() << 8) | spiRec();
-#if USE_SD_CRC
-  if (crc != CRC_CCITT(dst, count)) {
-    error(SD_CARD_ERROR_READ_CRC);
-    goto fail;
-  }
-#endif  // USE_SD_CRC
-
-  chipSelectHigh();
-  return true;
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/** read CID or CSR register */
-bool Sd2Card::readRegister(uint8_t cmd, void* buf) {
-  uint8_t* dst = reinterpret_cast<uint8_t*>(buf);
-  uint8_t retVal;
-  if (retVal = cardCommand(cmd, 0)) {
-    error(retVal); //aki iba SD_CARD_ERROR_READ_REG
-    goto fail;
-  }
-  return readData(dst, 16);
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/** Start a read multiple blocks sequence.
- *
- * \param[in] blockNumber Address of first block in sequence.
- *
- * \note This function is used with readData() and readStop() for optimized
- * multiple block reads.  SPI chipSelect must be low for the entire sequence.
- *
- * \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::readStart(uint32_t blockNumber) {
-  SD_TRACE("RS", blockNumber);
-  if (type()!= SD_CARD_TYPE_SDHC) blockNumber <<= 9;
-  if (cardCommand(CMD18, blockNumber)) {
-    error(SD_CARD_ERROR_CMD18);
-    goto fail;
-  }
-  chipSelectHigh();
-  return true;
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/** End a read multiple blocks sequence.
- *
-* \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::readStop() {
-  chipSelectLow();
-  if (cardCommand(CMD12, 0)) {
-    error(SD_CARD_ERROR_CMD12);
-    goto fail;
-  }
-  chipSelectHigh();
-  return true;
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/**
- * Set the SPI clock rate.
- *
- * \param[in] sckRateID A value in the range [0, 14].
- *
- * The SPI clock divisor will be set to approximately
- *
- * (2 + (sckRateID & 1)) << ( sckRateID/2)
- *
- * The maximum SPI rate is F_CPU/2 for \a sckRateID = 0 and the rate is
- * F_CPU/128 for \a scsRateID = 12.
- *
- * \return The value one, true, is returned for success and the value zero,
- * false, is returned for an invalid value of \a sckRateID.
- */
-bool Sd2Card::setSckRate(uint8_t sckRateID) {
-  if (sckRateID > MAX_SCK_RATE_ID) {
-    error(SD_CARD_ERROR_SCK_RATE);
-    return false;
-  }
-  spiRate_ = sckRateID;
-  return true;
-}
-//------------------------------------------------------------------------------
-// wait for card to go not busy
-bool Sd2Card::waitNotBusy(uint16_t timeoutMillis) {
-  uint16_t t0 = millis();
-  while (spiRec() != 0XFF) {
-    if (((uint16_t)millis() - t0) >= timeoutMillis) goto fail;
-  }
-  return true;
-
- fail:
-  return false;
-}
-//------------------------------------------------------------------------------
-/**
- * Writes a 512 byte block to an SD card.
- *
- * \param[in] blockNumber Logical block to be written.
- * \param[in] src Pointer to the location of the data to be written.
- * \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::writeBlock(uint32_t blockNumber, const uint8_t* src) {
-  SD_TRACE("WB", blockNumber);
-  // use address if not SDHC card
-  if (type() != SD_CARD_TYPE_SDHC) blockNumber <<= 9;
-  if (cardCommand(CMD24, blockNumber)) {
-    error(SD_CARD_ERROR_CMD24);
-    goto fail;
-  }
-  if (!writeData(DATA_START_BLOCK, src)) goto fail;
-  // wait for flash programming to complete
-  if (!waitNotBusy(SD_WRITE_TIMEOUT)) {
-    error(SD_CARD_ERROR_WRITE_TIMEOUT);
-    goto fail;
-  }
-  // response is r2 so get and check two bytes for nonzero
-  if (cardCommand(CMD13, 0) || spiRec()) {
-    error(SD_CARD_ERROR_WRITE_PROGRAMMING);
-    goto fail;
-  }
-  chipSelectHigh();
-  return true;
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/** Write one data block in a multiple block write sequence
- * \param[in] src Pointer to the location of the data to be written.
- * \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::writeData(const uint8_t* src) {
-  chipSelectLow();
-  // wait for previous write to finish
-  if (!waitNotBusy(SD_WRITE_TIMEOUT)) goto fail;
-  if (!writeData(WRITE_MULTIPLE_TOKEN, src)) goto fail;
-  chipSelectHigh();
-  return true;
-
- fail:
-  error(SD_CARD_ERROR_WRITE_MULTIPLE);
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-// send one block of data for write block or write multiple blocks
-bool Sd2Card::writeData(uint8_t token, const uint8_t* src) {
-#if USE_SD_CRC
-  uint16_t crc = CRC_CCITT(src, 512);
-#else  // USE_SD_CRC
-  uint16_t crc = 0XFFFF;
-#endif  // USE_SD_CRC
-
-  spiSend(token);
-  spiSend(src, 512);
-  spiSend(crc >> 8);
-  spiSend(crc & 0XFF);
-
-  status_ = spiRec();
-  if ((status_ & DATA_RES_MASK) != DATA_RES_ACCEPTED) {
-    error(SD_CARD_ERROR_WRITE);
-    goto fail;
-  }
-  return true;
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/** Start a write multiple blocks sequence.
- *
- * \param[in] blockNumber Address of first block in sequence.
- * \param[in] eraseCount The number of blocks to be pre-erased.
- *
- * \note This function is used with writeData() and writeStop()
- * for optimized multiple block writes.
- *
- * \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::writeStart(uint32_t blockNumber, uint32_t eraseCount) {
-  SD_TRACE("WS", blockNumber);
-  // send pre-erase count
-  if (cardAcmd(ACMD23, eraseCount)) {
-    error(SD_CARD_ERROR_ACMD23);
-    goto fail;
-  }
-  // use address if not SDHC card
-  if (type() != SD_CARD_TYPE_SDHC) blockNumber <<= 9;
-  if (cardCommand(CMD25, blockNumber)) {
-    error(SD_CARD_ERROR_CMD25);
-    goto fail;
-  }
-  chipSelectHigh();
-  return true;
-
- fail:
-  chipSelectHigh();
-  return false;
-}
-//------------------------------------------------------------------------------
-/** End a write multiple blocks sequence.
- *
-* \return The value one, true, is returned for success and
- * the value zero, false, is returned for failure.
- */
-bool Sd2Card::writeStop() {
-  chipSelectLow();
-  if (!waitNotBusy(SD_WRITE_TIMEOUT)) goto fail;
-  spiSend(STOP_TRAN_TOKEN);
-  if (!waitNotBusy(SD_WRITE_TIMEOUT)) goto fail;
-  chipSelectHigh();
-  return true;
-
- fail:
-  error(SD_CARD_ERROR_STOP_TRAN);
-  chipSelectHigh();
-  return false;
-}
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ *Creditos: https://github.com/frasermac/sdfatlib
+ */
+
+#include <Sd2Card.h>
+#if !USE_HOST_SD_CARD
+#include <SdCrc.h>
+// debug trace macro
+#define SD_TRACE(m, b) Serial.print(m);Serial.println(b);
+
+// SPI functions
+//==============================================================================
+#if USE_CUSTOM_SPI
+// transfers are done by functions the application supplies
+static void spiBegin() {
+  sdSpiBegin();
+}
+//------------------------------------------------------------------------------
+static void spiInit(uint8_t spiRate) {
+  sdSpiInit(spiRate);
+}
+//------------------------------------------------------------------------------
+/** SPI receive a byte */
+static uint8_t spiRec() {
+  return sdSpiRec();
+}
+//------------------------------------------------------------------------------
+/** SPI receive multiple bytes */
+static uint8_t spiRec(uint8_t* buf, size_t n) {
+  return sdSpiRec(buf, n);
+}
+//------------------------------------------------------------------------------
+/** SPI send a byte */
+static void spiSend(uint8_t b) {
+  sdSpiSend(b);
+}
+//------------------------------------------------------------------------------
+/** SPI send multiple bytes */
+static void spiSend(const uint8_t* buf, size_t n) {
+  sdSpiSend(buf, n);
+}
+//==============================================================================
+#elif USE_ARDUINO_SPI_LIBRARY
+#include <SPI.h>
+//------------------------------------------------------------------------------
+static void spiBegin() {
+  SPI.begin();
+}
+//------------------------------------------------------------------------------
+static void spiInit(uint8_t spiRate) {
+  SPI.setBitOrder(MSBFIRST);
+  SPI.setDataMode(SPI_MODE0);
+  int v;
+#ifdef SPI_CLOCK_DIV128
+  switch (spiRate/2) {
+    case 0: v = SPI_CLOCK_DIV2; break;
+    case 1: v = SPI_CLOCK_DIV4; break;
+    case 2: v = SPI_CLOCK_DIV8; break;
+    case 3: v = SPI_CLOCK_DIV16; break;
+    case 4: v = SPI_CLOCK_DIV32; break;
+    case 5: v = SPI_CLOCK_DIV64; break;
+    default: v = SPI_CLOCK_DIV128; break;
+  }
+#else  // SPI_CLOCK_DIV128
+  if (spiRate > 13) {
+    v = 255;
+  } else {
+    v = (2 | (spiRate & 1)) << (spiRate/2);
+  }
+#endif  // SPI_CLOCK_DIV128
+  SPI.setClockDivider(v);
+}
+//------------------------------------------------------------------------------
+/** SPI receive a byte */
+static  uint8_t spiRec() {
+  return SPI.transfer(0XFF);
+}
+//------------------------------------------------------------------------------
+/** SPI receive multiple bytes */
+static uint8_t spiRec(uint8_t* buf, size_t len) {
+#ifdef SPI_HAS_TRANSACTION
+  // the buffer transfer is pipelined, or uses DMA, on most cores
+  memset(buf, 0XFF, len);
+  SPI.transfer(buf, len);
+#else  // SPI_HAS_TRANSACTION
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = SPI.transfer(0XFF);
+  }
+#endif  // SPI_HAS_TRANSACTION
+  return 0;
+}
+//------------------------------------------------------------------------------
+/** SPI send a byte */
+static void spiSend(uint8_t b) {
+  SPI.transfer(b);
+}
+//------------------------------------------------------------------------------
+/** SPI send multiple bytes */
+static void spiSend(const uint8_t* buf, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    SPI.transfer(buf[i]);
+  }
+}
+#else
+#if (SPR0 != 0 || SPR1 != 1)
+#error unexpected SPCR bits
+#endif  
+//------------------------------------------------------------------------------
+/**
+ * initialize SPI pins
+ */
+static void spiBegin() {
+  // set SS high - may be chip select for another SPI device
+  digitalWrite(SS, HIGH);
+  // SS must be in output mode even it is not chip select
+  pinMode(SS, OUTPUT);
+  pinMode(MISO, INPUT);
+  pinMode(MOSI, OUTPUT);
+  pinMode(SCK, OUTPUT);
+}
+//------------------------------------------------------------------------------
+/**
+ * Initialize hardware SPI
+ * Set SCK rate to F_CPU/pow(2, 1 + spiRate) for spiRate [0,6]
+ */
+static void spiInit(uint8_t spiRate) {
+  spiRate = spiRate > 12 ? 6 : spiRate/2;
+  // See avr processor documentation
+  SPCR = (1 << SPE) | (1 << MSTR) | (spiRate >> 1);
+  SPSR = spiRate & 1 || spiRate == 6 ? 0 : 1 << SPI2X;
+}
+//------------------------------------------------------------------------------
+/** SPI receive a byte */
+static  uint8_t spiRec() {
+  SPDR = 0XFF;
+  while (!(SPSR & (1 << SPIF)));
+  return SPDR;
+}
+//------------------------------------------------------------------------------
+// Store the received byte and start the next one.  SPDR is loaded as soon
+// as it is read so the bus is idle only while the flag is polled.
+static inline uint8_t* spiRecNext(uint8_t* p) {
+  while (!(SPSR & (1 << SPIF)));
+  uint8_t b = SPDR;
+  SPDR = 0XFF;
+  *p = b;
+  return p + 1;
+}
+//------------------------------------------------------------------------------
+/** SPI receive multiple bytes */
+static uint8_t spiRec(uint8_t* buf, size_t n) {
+  if (n-- == 0) return 0;
+  uint8_t* end = buf + n;
+  // four bytes per loop test
+  uint8_t* end4 = buf + (n & ~3);
+  SPDR = 0XFF;
+  while (buf != end4) {
+    buf = spiRecNext(buf);
+    buf = spiRecNext(buf);
+    buf = spiRecNext(buf);
+    buf = spiRecNext(buf);
+  }
+  while (buf != end) buf = spiRecNext(buf);
+  while (!(SPSR & (1 << SPIF)));
+  *end = SPDR;
+  return 0;
+}
+//------------------------------------------------------------------------------
+/** SPI send a byte */
+static void spiSend(uint8_t b) {
+  SPDR = b;
+  while (!(SPSR & (1 << SPIF)));
+}
+//------------------------------------------------------------------------------
+// Send the byte loaded while the last one was shifted out and load the
+// following byte.
+static inline const uint8_t* spiSendNext(const uint8_t* p, uint8_t* b) {
+  while (!(SPSR & (1 << SPIF)));
+  SPDR = *b;
+  *b = *p;
+  return p + 1;
+}
+//------------------------------------------------------------------------------
+/** SPI send multiple bytes */
+static void spiSend(const uint8_t* buf , size_t n) {
+  if (n == 0) return;
+  const uint8_t* end = buf + n;
+  SPDR = *buf++;
+  if (buf == end) goto done;
+  {
+    uint8_t b = *buf++;
+    // four bytes per loop test
+    const uint8_t* end4 = buf + ((end - buf) & ~3);
+    while (buf != end4) {
+      buf = spiSendNext(buf, &b);
+      buf = spiSendNext(buf, &b);
+      buf = spiSendNext(buf, &b);
+      buf = spiSendNext(buf, &b);
+    }
+    while (buf != end) buf = spiSendNext(buf, &b);
+    while (!(SPSR & (1 << SPIF)));
+    SPDR = b;
+  }
+
+ done:
+  while (!(SPSR & (1 << SPIF)));
+}
+#endif  // USE_ARDUINO_SPI_LIBRARY
+//==============================================================================
+// Sd2Card member functions
+//------------------------------------------------------------------------------
+#if ASYNC_SD_QUEUE
+// phase of the oldest unfinished asynchronous request
+static uint8_t const ASYNC_IDLE = 0;        // not started
+static uint8_t const ASYNC_READ_TOKEN = 1;  // waiting for the start token
+static uint8_t const ASYNC_WRITE_BUSY = 2;  // card is programming
+//------------------------------------------------------------------------------
+// add a request to the queue and try to start it
+bool Sd2Card::asyncBegin(uint32_t block, uint8_t* buf, uint8_t write) {
+  if (asyncCount_ == ASYNC_SD_QUEUE) {
+    error(SD_CARD_ERROR_ASYNC_FULL);
+    return false;
+  }
+  SdAsyncRequest* r = &async_[(asyncHead_ + asyncCount_) % ASYNC_SD_QUEUE];
+  r->block = block;
+  r->buf = buf;
+  r->write = write;
+  r->status = 0;
+  if (asyncCount_++ == 0) asyncState_ = ASYNC_IDLE;
+  poll();
+  return true;
+}
+//------------------------------------------------------------------------------
+// send the command, and for a write the data, of a request
+bool Sd2Card::asyncStart(SdAsyncRequest* r) {
+  uint32_t addr = r->block;
+  if (type() != SD_CARD_TYPE_SDHC) addr <<= 9;
+  if (r->write) {
+    if (cardCommand(CMD24, addr)) {
+      error(SD_CARD_ERROR_CMD24);
+      goto fail;
+    }
+    if (!writeData(DATA_START_BLOCK, r->buf)) goto fail;
+    asyncState_ = ASYNC_WRITE_BUSY;
+  } else {
+    if (cardCommand(CMD17, addr)) {
+      error(SD_CARD_ERROR_CMD17);
+      goto fail;
+    }
+    // the card is selected until the data token and CRC are read
+    asyncState_ = ASYNC_READ_TOKEN;
+  }
+  if (asyncState_ == ASYNC_WRITE_BUSY) chipSelectHigh();
+  asyncMillis_ = millis();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/**
+ * Start an asynchronous read of one block.
+ *
+ * \param[in] block Logical block to be read.
+ * \param[out] dst Buffer for the data.  It must not be used until
+ * complete() has returned for this request.
+ *
+ * Requests are done in the order they are begun.  No other Sd2Card
+ * function may be called while requests are queued.  The card stays
+ * selected from the read command until its data is transferred, so other
+ * SPI devices can't be used until then.
+ *
+ * \return The value one, true, is returned for success and the value
+ * zero, false, is returned if ASYNC_SD_QUEUE requests are queued.
+ */
+bool Sd2Card::beginRead(uint32_t block, uint8_t* dst) {
+  return asyncBegin(block, dst, 0);
+}
+//------------------------------------------------------------------------------
+/**
+ * Start an asynchronous write of one block.  The card programs the block
+ * while the caller fills another buffer.
+ *
+ * \param[in] block Logical block to be written.
+ * \param[in] src Data to be written.  It must not be changed until
+ * complete() has returned for this request.
+ *
+ * \return The value one, true, is returned for success and the value
+ * zero, false, is returned if ASYNC_SD_QUEUE requests are queued.
+ */
+bool Sd2Card::beginWrite(uint32_t block, const uint8_t* src) {
+  return asyncBegin(block, const_cast<uint8_t*>(src), 1);
+}
+//------------------------------------------------------------------------------
+/**
+ * Wait for the oldest asynchronous request and remove it from the queue.
+ *
+ * \return The value one, true, is returned if the request succeeded or
+ * no request is queued.  The value zero, false, is returned if it failed.
+ */
+bool Sd2Card::complete() {
+  if (asyncCount_ == 0) return true;
+  while (!poll()) {}
+  SdAsyncRequest* r = &async_[asyncHead_];
+  asyncHead_ = (asyncHead_ + 1) % ASYNC_SD_QUEUE;
+  asyncCount_--;
+  asyncDone_--;
+  if (r->status) {
+    error(r->status);
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Move queued requests along without waiting.  A read is transferred when
+ * its data is ready and the next request is started when the card is no
+ * longer busy.
+ *
+ * \return true if complete() will not wait.
+ */
+bool Sd2Card::poll() {
+  while (asyncDone_ < asyncCount_) {
+    SdAsyncRequest* r = &async_[(asyncHead_ + asyncDone_) % ASYNC_SD_QUEUE];
+    uint16_t timeout;
+    if (asyncState_ == ASYNC_IDLE) {
+      if (!asyncStart(r)) goto fail;
+    }
+    chipSelectLow();
+    if (asyncState_ == ASYNC_READ_TOKEN) {
+      timeout = SD_READ_TIMEOUT;
+      if ((status_ = spiRec()) != 0XFF) {
+        if (status_ != DATA_START_BLOCK) {
+          error(SD_CARD_ERROR_READ);
+          goto fail;
+        }
+        if (status_ = spiRec(r->buf, 512)) {
+          error(SD_CARD_ERROR_SPI_DMA);
+          goto fail;
+        }
+        uint16_t crc = (spiRec() << 8) | spiRec();
+#if USE_SD_CRC
+        if (crc != CRC_CCITT(r->buf, 512)) {
+          error(SD_CARD_ERROR_READ_CRC);
+          goto fail;
+        }
+#else  // USE_SD_CRC
+        (void)crc;
+#endif  // USE_SD_CRC
+        goto done;
+      }
+    } else {
+      timeout = SD_WRITE_TIMEOUT;
+      if (spiRec() == 0XFF) {
+        // response is r2 so get and check two bytes for nonzero
+        if (cardCommand(CMD13, 0) || spiRec()) {
+          error(SD_CARD_ERROR_WRITE_PROGRAMMING);
+          goto fail;
+        }
+        goto done;
+      }
+    }
+    // only a card that is programming may be deselected
+    if (asyncState_ == ASYNC_WRITE_BUSY) chipSelectHigh();
+    if ((uint16_t)((uint16_t)millis() - asyncMillis_) <= timeout) break;
+    error(asyncState_ == ASYNC_READ_TOKEN ?
+          SD_CARD_ERROR_READ_TIMEOUT : SD_CARD_ERROR_WRITE_TIMEOUT);
+
+   fail:
+    r->status = errorCode_;
+   done:
+    chipSelectHigh();
+    asyncState_ = ASYNC_IDLE;
+    asyncDone_++;
+  }
+  return asyncDone_ != 0 || asyncCount_ == 0;
+}
+#endif  // ASYNC_SD_QUEUE
+//------------------------------------------------------------------------------
+// SCK frequency in kHz for a rate ID, see setSckRate()
+static uint32_t spiKHz(uint8_t sckRateID) {
+  return (F_CPU/1000) / ((2 + (sckRateID & 1)) << (sckRateID/2));
+}
+//------------------------------------------------------------------------------
+// maximum transfer rate in kbit/s from the CSD TRAN_SPEED field
+static uint32_t tranSpeedKHz(uint8_t tranSpeed) {
+  // time value times ten, then 100 kbit/s, 1, 10 or 100 Mbit/s units
+  static const uint8_t mult[16] =
+    {0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80};
+  uint32_t kHz = 10UL*mult[(tranSpeed >> 3) & 0XF];
+  for (uint8_t u = tranSpeed & 7; u > 0; u--) kHz *= 10;
+  return kHz;
+}
+//------------------------------------------------------------------------------
+/**
+ * Find the fastest SPI rate the card reads reliably at.
+ *
+ * A test block is read at SPI_SD_INIT_RATE, then the rate is raised one
+ * step at a time, up to the TRAN_SPEED limit in the CSD.  At each rate
+ * the block is read SD_TUNE_READS times; a read must match the CRC the
+ * card sends and the CRC read at the slow rate.  The fastest rate that
+ * passes is kept and returned by sckRate().
+ *
+ * \param[in] blockNumber The test block, any block that can be read.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned if the block can't be read at the
+ * slow rate.
+ */
+bool Sd2Card::autoSckRate(uint32_t blockNumber) {
+  csd_t csd;
+  uint16_t ref;
+  uint32_t maxKHz;
+  uint8_t best = SPI_SD_INIT_RATE;
+  spiRate_ = SPI_SD_INIT_RATE;
+  if (!readCSD(&csd) || !readCrc(blockNumber, &ref)) goto fail;
+  maxKHz = tranSpeedKHz(csd.v1.tran_speed);
+  for (uint8_t id = SPI_SD_INIT_RATE; id-- > 0;) {
+    if (spiKHz(id) > maxKHz) break;
+    spiRate_ = id;
+    for (uint8_t i = 0; i < SD_TUNE_READS; i++) {
+      uint16_t crc;
+      if (!readCrc(blockNumber, &crc) || crc != ref) goto done;
+    }
+    best = id;
+  }
+
+ done:
+  spiRate_ = best;
+  errorCode_ = 0;
+  return true;
+
+ fail:
+  spiRate_ = best;
+  return false;
+}
+//------------------------------------------------------------------------------
+// send command and return error code.  Return zero for OK
+uint8_t Sd2Card::cardCommand(uint8_t cmd, uint32_t arg) {
+  // select card
+  chipSelectLow();
+  // wait up to 300 ms if busy
+ // waitNotBusy(300);
+  // command and argument
+  uint8_t buf[5];
+  buf[0] = cmd | 0x40;
+  for (uint8_t i = 1; i < 5; i++) buf[i] = arg >> (32 - 8*i);
+  for (uint8_t i = 0; i < 5; i++) spiSend(buf[i]);
+
+  // send CRC
+#if USE_SD_CRC && !SD_CRC_READ_ONLY
+  spiSend(CRC7(buf, 5));
+#else  // USE_SD_CRC && !SD_CRC_READ_ONLY
+  uint8_t crc = 0XFF;
+  if (cmd == CMD0) crc = 0X95;  // correct crc for CMD0 with arg 0
+  if (cmd == CMD8) crc = 0X87;  // correct crc for CMD8 with arg 0X1AA
+  spiSend(crc);
+#endif  // USE_SD_CRC && !SD_CRC_READ_ONLY
+  // wait for response
+  for (uint8_t i = 0; ((status_ = spiRec()) & 0X80) && i != 0XFF; i++);
+  return status_;
+}
+//------------------------------------------------------------------------------
+void Sd2Card::chipSelectHigh() {
+  digitalWrite(chipSelectPin_, HIGH);
+  // insure MISO goes high impedance
+  spiSend(0XFF);
+}
+//------------------------------------------------------------------------------
+void Sd2Card::chipSelectLow() {
+  spiInit(spiRate_);
+  digitalWrite(chipSelectPin_, LOW);
+}
+/**
+ * Determine the size of an SD flash memory card.
+ *
+ * \return The number of 512 byte data blocks in the card
+ *         or zero if an error occurs.
+ */
+uint32_t Sd2Card::cardSize() {
+  csd_t csd;
+  if (!readCSD(&csd)) return 0;
+  if (csd.v1.csd_ver == 0) {
+    uint8_t read_bl_len = csd.v1.read_bl_len;
+    uint16_t c_size = (csd.v1.c_size_high << 10)
+                      | (csd.v1.c_size_mid << 2) | csd.v1.c_size_low;
+    uint8_t c_size_mult = (csd.v1.c_size_mult_high << 1)
+                          | csd.v1.c_size_mult_low;
+    return (uint32_t)(c_size + 1) << (c_size_mult + read_bl_len - 7);
+  } else if (csd.v2.csd_ver == 1) {
+    uint32_t c_size = 0X10000L * csd.v2.c_size_high + 0X100L
+                      * (uint32_t)csd.v2.c_size_mid + csd.v2.c_size_low;
+    return (c_size + 1) << 10;
+  } else {
+    error(SD_CARD_ERROR_BAD_CSD);
+    return 0;
+  }
+}
+//------------------------------------------------------------------------------
+/** Erase a range of blocks.
+ *
+ * \param[in] firstBlock The address of the first block in the range.
+ * \param[in] lastBlock The address of the last block in the range.
+ *
+ * \note This function requests the SD card to do a flash erase for a
+ * range of blocks.  The data on the card after an erase operation is
+ * either 0 or 1, depends on the card vendor.  The card must support
+ * single block erase.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::erase(uint32_t firstBlock, uint32_t lastBlock) {
+  csd_t csd;
+  if (!readCSD(&csd)) goto fail;
+  // check for single block erase
+  if (!csd.v1.erase_blk_en) {
+    // erase size mask
+    uint8_t m = (csd.v1.sector_size_high << 1) | csd.v1.sector_size_low;
+    if ((firstBlock & m) != 0 || ((lastBlock + 1) & m) != 0) {
+      // error card can't erase specified area
+      error(SD_CARD_ERROR_ERASE_SINGLE_BLOCK);
+      goto fail;
+    }
+  }
+  if (type_ != SD_CARD_TYPE_SDHC) {
+    firstBlock <<= 9;
+    lastBlock <<= 9;
+  }
+  if (cardCommand(CMD32, firstBlock)
+    || cardCommand(CMD33, lastBlock)
+    || cardCommand(CMD38, 0)) {
+      error(SD_CARD_ERROR_ERASE);
+      goto fail;
+  }
+  if (!waitNotBusy(SD_ERASE_TIMEOUT)) {
+    error(SD_CARD_ERROR_ERASE_TIMEOUT);
+    goto fail;
+  }
+  chipSelectHigh();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Determine if card supports single block erase.
+ *
+ * \return The value one, true, is returned if single block erase is supported.
+ * The value zero, false, is returned if single block erase is not supported.
+ */
+bool Sd2Card::eraseSingleBlockEnable() {
+  csd_t csd;
+  return readCSD(&csd) ? csd.v1.erase_blk_en : false;
+}
+//------------------------------------------------------------------------------
+/**
+ * Initialize an SD flash memory card.
+ *
+ * \param[in] sckRateID SPI clock rate selector. See setSckRate().  Use
+ * SPI_AUTO_SPEED to pick the rate with autoSckRate().
+ * \param[in] chipSelectPin SD chip select pin number.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.  The reason for failure
+ * can be determined by calling errorCode() and errorData().
+ */
+bool Sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin) {
+  errorCode_ = type_ = 0;
+  chipSelectPin_ = chipSelectPin;
+#if ASYNC_SD_QUEUE
+  asyncHead_ = asyncCount_ = asyncDone_ = 0;
+#endif  // ASYNC_SD_QUEUE
+  // 16-bit init start time allows over a minute
+  uint16_t t0 = (uint16_t)millis();
+  uint32_t arg;
+
+  pinMode(chipSelectPin_, OUTPUT);
+  digitalWrite(chipSelectPin_, LOW); 
+  digitalWrite(chipSelectPin_, HIGH);
+  spiBegin();
+
+  // set SCK rate for initialization commands
+  spiRate_ = SPI_SD_INIT_RATE;
+  spiInit(spiRate_);
+
+  // must supply min of 74 clock cycles with CS high.
+  for (uint8_t i = 0; i < 10; i++) spiSend(0XFF);
+
+  // command to go idle in SPI mode
+if(cardCommand(CMD0, 0) != R1_IDLE_STATE){
+  error(SD_CARD_ERROR_CMD0);
+    goto fail;
+  }
+#if USE_SD_CRC && !SD_CRC_READ_ONLY
+  // CRC_ON_OFF is only accepted in the idle state
+  if (cardCommand(CMD59, 1) != R1_IDLE_STATE) {
+    error(SD_CARD_ERROR_CMD59);
+    goto fail;
+  }
+#endif  // USE_SD_CRC && !SD_CRC_READ_ONLY
+  while (cardCommand(0X41, 0) != R1_READY_STATE) {
+    if (((uint16_t)millis() - t0) > SD_INIT_TIMEOUT) {
+      error(SD_CARD_ERROR_CMD0);
+      goto fail;
+    }
+  }
+
+  // check SD version
+   t0 = (uint16_t)millis();
+ /* while (1) {
+    if (cardCommand(CMD8, 0x1AA) == (R1_ILLEGAL_COMMAND | R1_IDLE_STATE)) {
+      type(SD_CARD_TYPE_SD1);
+      break;
+    }
+    for (uint8_t i = 0; i < 4; i++) status_ = spiRec();
+    if (status_ == 0XAA) {
+      type(SD_CARD_TYPE_SD2);
+      break;
+    }
+    if (((uint16_t)millis() - t0) > SD_INIT_TIMEOUT) {
+      error(SD_CARD_ERROR_CMD8);
+      goto fail;
+    }
+  }*/
+  chipSelectHigh();
+  if (sckRateID == SPI_AUTO_SPEED) return autoSckRate();
+  return setSckRate(sckRateID);
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+  //------------------------------------------------------------------------------
+/**
+ * Read a 512 byte block from an SD card.
+ *
+ * \param[in] blockNumber Logical block to be read.
+ * \param[out] dst Pointer to the location that will receive the data.
+
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readBlock(uint32_t blockNumber, uint8_t* dst) {
+  SD_TRACE("RB", blockNumber);
+  // use address if not SDHC card
+  if (type()!= SD_CARD_TYPE_SDHC) blockNumber <<= 9;
+  if (cardCommand(CMD17, blockNumber)) {
+    error(SD_CARD_ERROR_CMD17);
+    goto fail;
+  }
+  return readData(dst, 512);
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Read one data block in a multiple block read sequence
+ *
+ * \param[in] dst Pointer to the location for the data to be read.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readData(uint8_t *dst) {
+  chipSelectLow();
+  return readData(dst, 512);
+}
+//------------------------------------------------------------------------------
+bool Sd2Card::readData(uint8_t* dst, size_t count) {
+  uint16_t crc;
+  if (!waitStartBlock()) goto fail;
+  // transfer data
+  if (status_ = spiRec(dst, count)) {
+    error(SD_CARD_ERROR_SPI_DMA);
+    goto fail;
+  }
+  // get crc
+  crc = (spiRec() << 8) | spiRec();
+#if USE_SD_CRC
+  if (crc != CRC_CCITT(dst, count)) {
+    error(SD_CARD_ERROR_READ_CRC);
+    goto fail;
+  }
+#endif  // USE_SD_CRC
+
+  chipSelectHigh();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/**
+ * Read part of a 512 byte block from an SD card.
+ *
+ * The whole block is clocked out of the card, bytes outside the part are
+ * dropped so no 512 byte buffer is needed.
+ *
+ * \param[in] blockNumber Logical block to be read.
+ * \param[in] offset Number of bytes to skip at the start of the block.
+ * \param[in] count Number of bytes to read.
+ * \param[out] dst Pointer to the location that will receive the data.
+
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readPart(uint32_t blockNumber, uint16_t offset, uint16_t count,
+                       uint8_t* dst) {
+  uint16_t crc = 0;
+  uint16_t sent;
+  SD_TRACE("RP", blockNumber);
+  if ((offset + count) > 512) {
+    error(SD_CARD_ERROR_READ);
+    goto fail;
+  }
+  // use address if not SDHC card
+  if (type()!= SD_CARD_TYPE_SDHC) blockNumber <<= 9;
+  if (cardCommand(CMD17, blockNumber)) {
+    error(SD_CARD_ERROR_CMD17);
+    goto fail;
+  }
+  if (!waitStartBlock() || !readSkip(offset, &crc)) goto fail;
+  if (status_ = spiRec(dst, count)) {
+    error(SD_CARD_ERROR_SPI_DMA);
+    goto fail;
+  }
+#if USE_SD_CRC
+  crc = CRC_CCITT(dst, count, crc);
+#endif  // USE_SD_CRC
+  if (!readSkip(512 - offset - count, &crc)) goto fail;
+  sent = spiRec() << 8;
+  sent |= spiRec();
+#if USE_SD_CRC
+  if (sent != crc) {
+    error(SD_CARD_ERROR_READ_CRC);
+    goto fail;
+  }
+#endif  // USE_SD_CRC
+  chipSelectHigh();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+// receive and drop count bytes of a data block, their CRC is added to *crc
+bool Sd2Card::readSkip(uint16_t count, uint16_t* crc) {
+  uint8_t buf[16];
+  while (count) {
+    uint8_t n = count < sizeof(buf) ? count : sizeof(buf);
+    if (status_ = spiRec(buf, n)) {
+      error(SD_CARD_ERROR_SPI_DMA);
+      return false;
+    }
+#if USE_SD_CRC
+    *crc = CRC_CCITT(buf, n, *crc);
+#else  // USE_SD_CRC
+    (void)crc;
+#endif  // USE_SD_CRC
+    count -= n;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+// read a block in pieces and check the CRC sent by the card, the CRC is
+// returned so reads at different rates can be compared
+bool Sd2Card::readCrc(uint32_t blockNumber, uint16_t* crc) {
+  uint8_t buf[32];
+  uint16_t calc = 0;
+  if (type()!= SD_CARD_TYPE_SDHC) blockNumber <<= 9;
+  if (cardCommand(CMD17, blockNumber)) {
+    error(SD_CARD_ERROR_CMD17);
+    goto fail;
+  }
+  if (!waitStartBlock()) goto fail;
+  for (uint8_t i = 0; i < 512/sizeof(buf); i++) {
+    if (status_ = spiRec(buf, sizeof(buf))) {
+      error(SD_CARD_ERROR_SPI_DMA);
+      goto fail;
+    }
+    calc = CRC_CCITT(buf, sizeof(buf), calc);
+  }
+  *crc = spiRec() << 8;
+  *crc |= spiRec();
+  if (*crc != calc) {
+    error(SD_CARD_ERROR_READ_CRC);
+    goto fail;
+  }
+  chipSelectHigh();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/** read CID or CSR register */
+bool Sd2Card::readRegister(uint8_t cmd, void* buf) {
+  uint8_t* dst = reinterpret_cast<uint8_t*>(buf);
+  uint8_t retVal;
+  if (retVal = cardCommand(cmd, 0)) {
+    error(retVal); //aki iba SD_CARD_ERROR_READ_REG
+    goto fail;
+  }
+  return readData(dst, 16);
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Start a read multiple blocks sequence.
+ *
+ * \param[in] blockNumber Address of first block in sequence.
+ *
+ * \note This function is used with readData() and readStop() for optimized
+ * multiple block reads.  SPI chipSelect must be low for the entire sequence.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readStart(uint32_t blockNumber) {
+  SD_TRACE("RS", blockNumber);
+  if (type()!= SD_CARD_TYPE_SDHC) blockNumber <<= 9;
+  if (cardCommand(CMD18, blockNumber)) {
+    error(SD_CARD_ERROR_CMD18);
+    goto fail;
+  }
+  chipSelectHigh();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/** End a read multiple blocks sequence.
+ *
+* \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readStop() {
+  chipSelectLow();
+  if (cardCommand(CMD12, 0)) {
+    error(SD_CARD_ERROR_CMD12);
+    goto fail;
+  }
+  chipSelectHigh();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/**
+ * Set the SPI clock rate.
+ *
+ * \param[in] sckRateID A value in the range [0, 14].
+ *
+ * The SPI clock divisor will be set to approximately
+ *
+ * (2 + (sckRateID & 1)) << ( sckRateID/2)
+ *
+ * The maximum SPI rate is F_CPU/2 for \a sckRateID = 0 and the rate is
+ * F_CPU/128 for \a scsRateID = 12.
+ *
+ * \return The value one, true, is returned for success and the value zero,
+ * false, is returned for an invalid value of \a sckRateID.
+ */
+bool Sd2Card::setSckRate(uint8_t sckRateID) {
+  if (sckRateID > MAX_SCK_RATE_ID) {
+    error(SD_CARD_ERROR_SCK_RATE);
+    return false;
+  }
+  spiRate_ = sckRateID;
+  return true;
+}
+//------------------------------------------------------------------------------
+// wait for the start block token of a data read
+bool Sd2Card::waitStartBlock() {
+  uint16_t t0 = millis();
+  while ((status_ = spiRec()) == 0XFF) {
+    if (((uint16_t)millis() - t0) > SD_READ_TIMEOUT) {
+      error(SD_CARD_ERROR_READ_TIMEOUT);
+      return false;
+    }
+  }
+  if (status_ != DATA_START_BLOCK) {
+    error(SD_CARD_ERROR_READ);
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+// wait for card to go not busy
+bool Sd2Card::waitNotBusy(uint16_t timeoutMillis) {
+  uint16_t t0 = millis();
+  while (spiRec() != 0XFF) {
+    if (((uint16_t)millis() - t0) >= timeoutMillis) goto fail;
+  }
+  return true;
+
+ fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+/**
+ * Writes a 512 byte block to an SD card.
+ *
+ * \param[in] blockNumber Logical block to be written.
+ * \param[in] src Pointer to the location of the data to be written.
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::writeBlock(uint32_t blockNumber, const uint8_t* src) {
+  SD_TRACE("WB", blockNumber);
+  // use address if not SDHC card
+  if (type() != SD_CARD_TYPE_SDHC) blockNumber <<= 9;
+  if (cardCommand(CMD24, blockNumber)) {
+    error(SD_CARD_ERROR_CMD24);
+    goto fail;
+  }
+  if (!writeData(DATA_START_BLOCK, src)) goto fail;
+  // wait for flash programming to complete
+  if (!waitNotBusy(SD_WRITE_TIMEOUT)) {
+    error(SD_CARD_ERROR_WRITE_TIMEOUT);
+    goto fail;
+  }
+  // response is r2 so get and check two bytes for nonzero
+  if (cardCommand(CMD13, 0) || spiRec()) {
+    error(SD_CARD_ERROR_WRITE_PROGRAMMING);
+    goto fail;
+  }
+  chipSelectHigh();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Write one data block in a multiple block write sequence
+ * \param[in] src Pointer to the location of the data to be written.
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::writeData(const uint8_t* src) {
+  chipSelectLow();
+  // wait for previous write to finish
+  if (!waitNotBusy(SD_WRITE_TIMEOUT)) goto fail;
+  if (!writeData(WRITE_MULTIPLE_TOKEN, src)) goto fail;
+  chipSelectHigh();
+  return true;
+
+ fail:
+  error(SD_CARD_ERROR_WRITE_MULTIPLE);
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+// send one block of data for write block or write multiple blocks
+bool Sd2Card::writeData(uint8_t token, const uint8_t* src) {
+#if USE_SD_CRC && !SD_CRC_READ_ONLY
+  uint16_t crc = CRC_CCITT(src, 512);
+#else  // USE_SD_CRC && !SD_CRC_READ_ONLY
+  uint16_t crc = 0XFFFF;
+#endif  // USE_SD_CRC && !SD_CRC_READ_ONLY
+
+  spiSend(token);
+  spiSend(src, 512);
+  spiSend(crc >> 8);
+  spiSend(crc & 0XFF);
+
+  status_ = spiRec();
+  if ((status_ & DATA_RES_MASK) != DATA_RES_ACCEPTED) {
+    error(SD_CARD_ERROR_WRITE);
+    goto fail;
+  }
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Start a write multiple blocks sequence.
+ *
+ * \param[in] blockNumber Address of first block in sequence.
+ * \param[in] eraseCount The number of blocks to be pre-erased.
+ *
+ * \note This function is used with writeData() and writeStop()
+ * for optimized multiple block writes.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::writeStart(uint32_t blockNumber, uint32_t eraseCount) {
+  SD_TRACE("WS", blockNumber);
+  // send pre-erase count
+  if (cardAcmd(ACMD23, eraseCount)) {
+    error(SD_CARD_ERROR_ACMD23);
+    goto fail;
+  }
+  // use address if not SDHC card
+  if (type() != SD_CARD_TYPE_SDHC) blockNumber <<= 9;
+  if (cardCommand(CMD25, blockNumber)) {
+    error(SD_CARD_ERROR_CMD25);
+    goto fail;
+  }
+  chipSelectHigh();
+  return true;
+
+ fail:
+  chipSelectHigh();
+  return false;
+}
+//------------------------------------------------------------------------------
+/** End a write multiple blocks sequence.
+ *
+* \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::writeStop() {
+  chipSelectLow();
+  if (!waitNotBusy(SD_WRITE_TIMEOUT)) goto fail;
+  spiSend(STOP_TRAN_TOKEN);
+  if (!waitNotBusy(SD_WRITE_TIMEOUT)) goto fail;
+  chipSelectHigh();
+  return true;
+
+ fail:
+  error(SD_CARD_ERROR_STOP_TRAN);
+  chipSelectHigh();
+  return false;
+}
+#endif  // !USE_HOST_SD_CARD
\ No newline at end of file
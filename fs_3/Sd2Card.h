@@ -1,215 +1,387 @@
-/* Arduino PFS Library
- * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
- *
- * This file is part of the Arduino PFS Library
- *
- * This Library is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This Library is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with the Arduino PFS Library.  If not, see
- * <http://www.gnu.org/licenses/>.
- */
-/*
- *Creditos: https://github.com/frasermac/sdfatlib
- */
-
-#ifndef Sd2Card_h
-#define Sd2Card_h
-/**
- * \file
- * \brief Sd2Card class for V2 SD/SDHC cards
- */
-#include <Arduino.h>
-#include <SdPfsConfig.h>
-#include <SdMeta.h>
-//------------------------------------------------------------------------------
-// SPI speed is F_CPU/2^(1 + index), 0 <= index <= 6
-/** Set SCK to max rate of F_CPU/2. See Sd2Card::setSckRate(). */
-uint8_t const SPI_FULL_SPEED = 0;
-/** Set SCK rate to F_CPU/3 for Due */
-uint8_t const SPI_DIV3_SPEED = 1;
-/** Set SCK rate to F_CPU/4. See Sd2Card::setSckRate(). */
-uint8_t const SPI_HALF_SPEED = 2;
-/** Set SCK rate to F_CPU/6 for Due */
-uint8_t const SPI_DIV6_SPEED = 3;
-/** Set SCK rate to F_CPU/8. See Sd2Card::setSckRate(). */
-uint8_t const SPI_QUARTER_SPEED = 4;
-/** Set SCK rate to F_CPU/16. See Sd2Card::setSckRate(). */
-uint8_t const SPI_EIGHTH_SPEED = 6;
-/** Set SCK rate to F_CPU/32. See Sd2Card::setSckRate(). */
-uint8_t const SPI_SIXTEENTH_SPEED = 8;
-/** MAX rate test - see spiInit for a given chip for details */
-const uint8_t MAX_SCK_RATE_ID = 14;
-//------------------------------------------------------------------------------
-/** init timeout ms */
-uint16_t const SD_INIT_TIMEOUT = 4000;
-/** erase timeout ms */
-uint16_t const SD_ERASE_TIMEOUT = 10000;
-/** read timeout ms */
-uint16_t const SD_READ_TIMEOUT = 300;
-/** write time out ms */
-uint16_t const SD_WRITE_TIMEOUT = 600;
-//------------------------------------------------------------------------------
-// SD card errors
-/** timeout error for command CMD0 (initialize card in SPI mode) */
-uint8_t const SD_CARD_ERROR_CMD0 = 0X1;
-/** CMD8 was not accepted - not a valid SD card*/
-uint8_t const SD_CARD_ERROR_CMD8 = 0X2;
-/** card returned an error response for CMD12 (write stop) */
-uint8_t const SD_CARD_ERROR_CMD12 = 0X3;
-/** card returned an error response for CMD17 (read block) */
-uint8_t const SD_CARD_ERROR_CMD17 = 0X4;
-/** card returned an error response for CMD18 (read multiple block) */
-uint8_t const SD_CARD_ERROR_CMD18 = 0X5;
-/** card returned an error response for CMD24 (write block) */
-uint8_t const SD_CARD_ERROR_CMD24 = 0X6;
-/**  WRITE_MULTIPLE_BLOCKS command failed */
-uint8_t const SD_CARD_ERROR_CMD25 = 0X7;
-/** card returned an error response for CMD58 (read OCR) */
-uint8_t const SD_CARD_ERROR_CMD58 = 0X8;
-/** SET_WR_BLK_ERASE_COUNT failed */
-uint8_t const SD_CARD_ERROR_ACMD23 = 0X9;
-/** ACMD41 initialization process timeout */
-uint8_t const SD_CARD_ERROR_ACMD41 = 0XA;
-/** card returned a bad CSR version field */
-uint8_t const SD_CARD_ERROR_BAD_CSD = 0XB;
-/** erase block group command failed */
-uint8_t const SD_CARD_ERROR_ERASE = 0XC;
-/** card not capable of single block erase */
-uint8_t const SD_CARD_ERROR_ERASE_SINGLE_BLOCK = 0XD;
-/** Erase sequence timed out */
-uint8_t const SD_CARD_ERROR_ERASE_TIMEOUT = 0XE;
-/** card returned an error token instead of read data */
-uint8_t const SD_CARD_ERROR_READ = 0XF;
-/** read CID or CSD failed */
-uint8_t const SD_CARD_ERROR_READ_REG = 0X10;
-/** timeout while waiting for start of read data */
-uint8_t const SD_CARD_ERROR_READ_TIMEOUT = 0X11;
-/** card did not accept STOP_TRAN_TOKEN */
-uint8_t const SD_CARD_ERROR_STOP_TRAN = 0X12;
-/** card returned an error token as a response to a write operation */
-uint8_t const SD_CARD_ERROR_WRITE = 0X13;
-/** attempt to write protected block zero */
-uint8_t const SD_CARD_ERROR_WRITE_BLOCK_ZERO = 0X14;  // REMOVE - not used
-/** card did not go ready for a multiple block write */
-uint8_t const SD_CARD_ERROR_WRITE_MULTIPLE = 0X15;
-/** card returned an error to a CMD13 status check after a write */
-uint8_t const SD_CARD_ERROR_WRITE_PROGRAMMING = 0X16;
-/** timeout occurred during write programming */
-uint8_t const SD_CARD_ERROR_WRITE_TIMEOUT = 0X17;
-/** incorrect rate selected */
-uint8_t const SD_CARD_ERROR_SCK_RATE = 0X18;
-/** init() not called */
-uint8_t const SD_CARD_ERROR_INIT_NOT_CALLED = 0X19;
-/** card returned an error for CMD59 (CRC_ON_OFF) */
-uint8_t const SD_CARD_ERROR_CMD59 = 0X1A;
-/** invalid read CRC */
-uint8_t const SD_CARD_ERROR_READ_CRC = 0X1B;
-/** SPI DMA error */
-uint8_t const SD_CARD_ERROR_SPI_DMA = 0X1C;
-//------------------------------------------------------------------------------
-// card types
-/** Standard capacity V1 SD card */
-uint8_t const SD_CARD_TYPE_SD1  = 1;
-/** Standard capacity V2 SD card */
-uint8_t const SD_CARD_TYPE_SD2  = 2;
-/** High Capacity SD card */
-uint8_t const SD_CARD_TYPE_SDHC = 3;
-
-/** SPI chip select pin */
-uint8_t const  SD_CHIP_SELECT_PIN = SS;
-
-class Sd2Card {
- public:
-  /** Construct an instance of Sd2Card. */
-  Sd2Card() : errorCode_(SD_CARD_ERROR_INIT_NOT_CALLED), type_(0) {}
-  uint32_t cardSize();
-  bool erase(uint32_t firstBlock, uint32_t lastBlock);
-  bool eraseSingleBlockEnable();
-  /**
-   *  Set SD error code.
-   *  \param[in] code value for error code.
-   */
-  void error(uint8_t code) {errorCode_ = code;}
-  /**
-   * \return error code for last error. See Sd2Card.h for a list of error codes.
-   */
-  int errorCode() const {return errorCode_;}
-  /** \return error data for last error. */
-  int errorData() const {return status_;}
-  /**
-   * Initialize an SD flash memory card with default clock rate and chip
-   * select pin.  See sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin).
-   *
-   * \return true for success or false for failure.
-   */
-  bool init(uint8_t sckRateID = SPI_FULL_SPEED,
-    uint8_t chipSelectPin = SD_CHIP_SELECT_PIN);
-  bool readBlock(uint32_t block, uint8_t* dst);
-  /**
-   * Read a card's CID register. The CID contains card identification
-   * information such as Manufacturer ID, Product name, Product serial
-   * number and Manufacturing date. 
-   *
-   * \param[out] cid pointer to area for returned data.
-   *
-   * \return true for success or false for failure.
-   */
-  bool readCID(cid_t* cid) {
-    return readRegister(CMD10, cid);
-  }
-  /**
-   * Read a card's CSD register. The CSD contains Card-Specific Data that
-   * provides information regarding access to the card's contents.
-   *
-   * \param[out] csd pointer to area for returned data.
-   *
-   * \return true for success or false for failure.
-   */
-  bool readCSD(csd_t* csd) {
-    return readRegister(CMD9, csd);
-  }
-  bool readData(uint8_t *dst);
-  bool readStart(uint32_t blockNumber);
-  bool readStop();
-  bool setSckRate(uint8_t sckRateID);
-  /** Return the card type: SD V1, SD V2 or SDHC
-   * \return 0 - SD V1, 1 - SD V2, or 3 - SDHC.
-   */
-  int type() const {return type_;}
-  bool writeBlock(uint32_t blockNumber, const uint8_t* src);
-  bool writeData(const uint8_t* src);
-  bool writeStart(uint32_t blockNumber, uint32_t eraseCount);
-  bool writeStop();
-
- private:
-  //----------------------------------------------------------------------------
-  uint8_t chipSelectPin_;
-  uint8_t errorCode_;
-  uint8_t spiRate_;
-  uint8_t status_;
-  uint8_t type_;
-  // private functions
-  uint8_t cardAcmd(uint8_t cmd, uint32_t arg) {
-    cardCommand(CMD55, 0);
-    return cardCommand(cmd, arg);
-  }
-  uint8_t cardCommand(uint8_t cmd, uint32_t arg);
-  bool readData(uint8_t* dst, size_t count);
-  bool readRegister(uint8_t cmd, void* buf);
-  void chipSelectHigh();
-  void chipSelectLow();
-  void type(uint8_t value) {type_ = value;}
-  bool waitNotBusy(uint16_t timeoutMillis);
-  bool writeData(uint8_t token, const uint8_t* src);
-};
-
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ *Creditos: https://github.com/frasermac/sdfatlib
+ */
+
+#ifndef Sd2Card_h
+#define Sd2Card_h
+/**
+ * \file
+ * \brief Sd2Card class for V2 SD/SDHC cards
+ */
+#include <SdPfsConfig.h>
+#if USE_HOST_SD_CARD
+#include <stddef.h>
+#include <string.h>
+#if ASYNC_SD_QUEUE
+#include <pthread.h>
+#endif  // ASYNC_SD_QUEUE
+unsigned long millis();
+#else  // USE_HOST_SD_CARD
+#include <Arduino.h>
+#endif  // USE_HOST_SD_CARD
+#include <SdMeta.h>
+//------------------------------------------------------------------------------
+// SPI speed is F_CPU/2^(1 + index), 0 <= index <= 6
+/** Set SCK to max rate of F_CPU/2. See Sd2Card::setSckRate(). */
+uint8_t const SPI_FULL_SPEED = 0;
+/** Set SCK rate to F_CPU/3 for Due */
+uint8_t const SPI_DIV3_SPEED = 1;
+/** Set SCK rate to F_CPU/4. See Sd2Card::setSckRate(). */
+uint8_t const SPI_HALF_SPEED = 2;
+/** Set SCK rate to F_CPU/6 for Due */
+uint8_t const SPI_DIV6_SPEED = 3;
+/** Set SCK rate to F_CPU/8. See Sd2Card::setSckRate(). */
+uint8_t const SPI_QUARTER_SPEED = 4;
+/** Set SCK rate to F_CPU/16. See Sd2Card::setSckRate(). */
+uint8_t const SPI_EIGHTH_SPEED = 6;
+/** Set SCK rate to F_CPU/32. See Sd2Card::setSckRate(). */
+uint8_t const SPI_SIXTEENTH_SPEED = 8;
+/** MAX rate test - see spiInit for a given chip for details */
+const uint8_t MAX_SCK_RATE_ID = 14;
+/** Pick the rate with Sd2Card::autoSckRate(). See Sd2Card::init(). */
+uint8_t const SPI_AUTO_SPEED = 0XFF;
+//------------------------------------------------------------------------------
+/** init timeout ms */
+uint16_t const SD_INIT_TIMEOUT = 4000;
+/** erase timeout ms */
+uint16_t const SD_ERASE_TIMEOUT = 10000;
+/** read timeout ms */
+uint16_t const SD_READ_TIMEOUT = 300;
+/** write time out ms */
+uint16_t const SD_WRITE_TIMEOUT = 600;
+/** reads of the test block at each rate tried by Sd2Card::autoSckRate() */
+uint8_t const SD_TUNE_READS = 4;
+//------------------------------------------------------------------------------
+// SD card errors
+/** timeout error for command CMD0 (initialize card in SPI mode) */
+uint8_t const SD_CARD_ERROR_CMD0 = 0X1;
+/** CMD8 was not accepted - not a valid SD card*/
+uint8_t const SD_CARD_ERROR_CMD8 = 0X2;
+/** card returned an error response for CMD12 (write stop) */
+uint8_t const SD_CARD_ERROR_CMD12 = 0X3;
+/** card returned an error response for CMD17 (read block) */
+uint8_t const SD_CARD_ERROR_CMD17 = 0X4;
+/** card returned an error response for CMD18 (read multiple block) */
+uint8_t const SD_CARD_ERROR_CMD18 = 0X5;
+/** card returned an error response for CMD24 (write block) */
+uint8_t const SD_CARD_ERROR_CMD24 = 0X6;
+/**  WRITE_MULTIPLE_BLOCKS command failed */
+uint8_t const SD_CARD_ERROR_CMD25 = 0X7;
+/** card returned an error response for CMD58 (read OCR) */
+uint8_t const SD_CARD_ERROR_CMD58 = 0X8;
+/** SET_WR_BLK_ERASE_COUNT failed */
+uint8_t const SD_CARD_ERROR_ACMD23 = 0X9;
+/** ACMD41 initialization process timeout */
+uint8_t const SD_CARD_ERROR_ACMD41 = 0XA;
+/** card returned a bad CSR version field */
+uint8_t const SD_CARD_ERROR_BAD_CSD = 0XB;
+/** erase block group command failed */
+uint8_t const SD_CARD_ERROR_ERASE = 0XC;
+/** card not capable of single block erase */
+uint8_t const SD_CARD_ERROR_ERASE_SINGLE_BLOCK = 0XD;
+/** Erase sequence timed out */
+uint8_t const SD_CARD_ERROR_ERASE_TIMEOUT = 0XE;
+/** card returned an error token instead of read data */
+uint8_t const SD_CARD_ERROR_READ = 0XF;
+/** read CID or CSD failed */
+uint8_t const SD_CARD_ERROR_READ_REG = 0X10;
+/** timeout while waiting for start of read data */
+uint8_t const SD_CARD_ERROR_READ_TIMEOUT = 0X11;
+/** card did not accept STOP_TRAN_TOKEN */
+uint8_t const SD_CARD_ERROR_STOP_TRAN = 0X12;
+/** card returned an error token as a response to a write operation */
+uint8_t const SD_CARD_ERROR_WRITE = 0X13;
+/** attempt to write protected block zero */
+uint8_t const SD_CARD_ERROR_WRITE_BLOCK_ZERO = 0X14;  // REMOVE - not used
+/** card did not go ready for a multiple block write */
+uint8_t const SD_CARD_ERROR_WRITE_MULTIPLE = 0X15;
+/** card returned an error to a CMD13 status check after a write */
+uint8_t const SD_CARD_ERROR_WRITE_PROGRAMMING = 0X16;
+/** timeout occurred during write programming */
+uint8_t const SD_CARD_ERROR_WRITE_TIMEOUT = 0X17;
+/** incorrect rate selected */
+uint8_t const SD_CARD_ERROR_SCK_RATE = 0X18;
+/** init() not called */
+uint8_t const SD_CARD_ERROR_INIT_NOT_CALLED = 0X19;
+/** card returned an error for CMD59 (CRC_ON_OFF) */
+uint8_t const SD_CARD_ERROR_CMD59 = 0X1A;
+/** invalid read CRC */
+uint8_t const SD_CARD_ERROR_READ_CRC = 0X1B;
+/** SPI DMA error */
+uint8_t const SD_CARD_ERROR_SPI_DMA = 0X1C;
+/** asynchronous request queue is full */
+uint8_t const SD_CARD_ERROR_ASYNC_FULL = 0X1D;
+//------------------------------------------------------------------------------
+// card types
+/** Standard capacity V1 SD card */
+uint8_t const SD_CARD_TYPE_SD1  = 1;
+/** Standard capacity V2 SD card */
+uint8_t const SD_CARD_TYPE_SD2  = 2;
+/** High Capacity SD card */
+uint8_t const SD_CARD_TYPE_SDHC = 3;
+
+#if USE_HOST_SD_CARD
+/** chip select is not used by the host card */
+uint8_t const  SD_CHIP_SELECT_PIN = 0;
+//------------------------------------------------------------------------------
+/**
+ * \struct SdHostLatency
+ * \brief Timing model for the file backed host card.  All times are in
+ * nanoseconds, zero disables that part of the model.
+ */
+struct SdHostLatency {
+           /** overhead for each command sent to the card */
+  uint32_t commandNanos;
+           /** time to transfer one 512 byte block over the bus */
+  uint32_t blockNanos;
+           /** program time for each written block that was not
+               pre-erased by the eraseCount of writeStart() */
+  uint32_t programNanos;
+           /** busy time after each write command, at the end of a single
+               block write or of a multiple block sequence */
+  uint32_t busyNanos;
+           /** busy time for an erase command */
+  uint32_t eraseNanos;
+};
+//------------------------------------------------------------------------------
+/**
+ * \struct SdHostStats
+ * \brief Counters kept by the file backed host card.
+ */
+struct SdHostStats {
+           /** number of commands sent to the card */
+  uint32_t commands;
+           /** number of blocks read */
+  uint32_t blocksRead;
+           /** number of blocks written */
+  uint32_t blocksWritten;
+           /** number of blocks erased */
+  uint32_t blocksErased;
+           /** time spent in the latency model */
+  uint64_t modelNanos;
+};
+#else  // USE_HOST_SD_CARD
+/** SPI chip select pin */
+uint8_t const  SD_CHIP_SELECT_PIN = SS;
+#if USE_CUSTOM_SPI
+//------------------------------------------------------------------------------
+// SPI transfer functions the application supplies if USE_CUSTOM_SPI is set
+/** Set up the SPI pins. */
+void sdSpiBegin();
+/** Set the SCK rate, see Sd2Card::setSckRate() for \a spiRate. */
+void sdSpiInit(uint8_t spiRate);
+/** \return A byte received while sending 0XFF. */
+uint8_t sdSpiRec();
+/** Receive \a n bytes while sending 0XFF.  \return Zero for success. */
+uint8_t sdSpiRec(uint8_t* buf, size_t n);
+/** Send one byte. */
+void sdSpiSend(uint8_t b);
+/** Send \a n bytes. */
+void sdSpiSend(const uint8_t* buf, size_t n);
+#endif  // USE_CUSTOM_SPI
+#endif  // USE_HOST_SD_CARD
+#if ASYNC_SD_QUEUE
+//------------------------------------------------------------------------------
+/**
+ * \struct SdAsyncRequest
+ * \brief One block read or write queued by Sd2Card::beginRead() or
+ * Sd2Card::beginWrite().
+ */
+struct SdAsyncRequest {
+          /** block to read or write */
+  uint32_t block;
+          /** data buffer, owned by the card until complete() */
+  uint8_t* buf;
+          /** nonzero for a write */
+  uint8_t write;
+          /** zero for success else an SD_CARD_ERROR code */
+  uint8_t status;
+};
+#endif  // ASYNC_SD_QUEUE
+
+class Sd2Card {
+ public:
+  /** Construct an instance of Sd2Card. */
+#if USE_HOST_SD_CARD
+  Sd2Card() : errorCode_(SD_CARD_ERROR_INIT_NOT_CALLED), type_(0), fd_(-1),
+    blockCount_(0) {
+#if ASYNC_SD_QUEUE
+    asyncHead_ = asyncCount_ = asyncDone_ = 0;
+    asyncRun_ = false;
+#endif  // ASYNC_SD_QUEUE
+    memset(&latency_, 0, sizeof(latency_));
+    clearStats();
+  }
+  ~Sd2Card() {end();}
+#else  // USE_HOST_SD_CARD
+  Sd2Card() : errorCode_(SD_CARD_ERROR_INIT_NOT_CALLED), type_(0) {
+#if ASYNC_SD_QUEUE
+    asyncHead_ = asyncCount_ = asyncDone_ = 0;
+#endif  // ASYNC_SD_QUEUE
+  }
+#endif  // USE_HOST_SD_CARD
+#if ASYNC_SD_QUEUE
+  /** \return Number of requests begun and not yet completed. */
+  uint8_t asyncCount() const {return asyncCount_;}
+  bool beginRead(uint32_t block, uint8_t* dst);
+  bool beginWrite(uint32_t block, const uint8_t* src);
+  bool complete();
+  bool poll();
+#endif  // ASYNC_SD_QUEUE
+  bool autoSckRate(uint32_t blockNumber = 0);
+  uint32_t cardSize();
+  bool erase(uint32_t firstBlock, uint32_t lastBlock);
+  bool eraseSingleBlockEnable();
+  /**
+   *  Set SD error code.
+   *  \param[in] code value for error code.
+   */
+  void error(uint8_t code) {errorCode_ = code;}
+  /**
+   * \return error code for last error. See Sd2Card.h for a list of error codes.
+   */
+  int errorCode() const {return errorCode_;}
+  /** \return error data for last error. */
+  int errorData() const {return status_;}
+  /**
+   * Initialize an SD flash memory card with default clock rate and chip
+   * select pin.  See sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin).
+   *
+   * \return true for success or false for failure.
+   */
+  bool init(uint8_t sckRateID = SPI_FULL_SPEED,
+    uint8_t chipSelectPin = SD_CHIP_SELECT_PIN);
+#if USE_HOST_SD_CARD
+  bool init(const char* path);
+  void end();
+  /** Reset the host card counters. */
+  void clearStats() {memset(&stats_, 0, sizeof(stats_));}
+  /**
+   * Set the timing model used by the host card.
+   * \param[in] latency New timing model.
+   */
+  void setLatency(const SdHostLatency& latency) {latency_ = latency;}
+  /** \return The counters kept by the host card. */
+  const SdHostStats& stats() const {return stats_;}
+  /** \return Descriptor of the image file, -1 if none.  Other threads
+   *  may pread() it while the card is idle. */
+  int fd() const {return fd_;}
+#endif  // USE_HOST_SD_CARD
+  bool readBlock(uint32_t block, uint8_t* dst);
+  /**
+   * Read a card's CID register. The CID contains card identification
+   * information such as Manufacturer ID, Product name, Product serial
+   * number and Manufacturing date. 
+   *
+   * \param[out] cid pointer to area for returned data.
+   *
+   * \return true for success or false for failure.
+   */
+  bool readCID(cid_t* cid) {
+    return readRegister(CMD10, cid);
+  }
+  /**
+   * Read a card's CSD register. The CSD contains Card-Specific Data that
+   * provides information regarding access to the card's contents.
+   *
+   * \param[out] csd pointer to area for returned data.
+   *
+   * \return true for success or false for failure.
+   */
+  bool readCSD(csd_t* csd) {
+    return readRegister(CMD9, csd);
+  }
+  bool readData(uint8_t *dst);
+  bool readPart(uint32_t blockNumber, uint16_t offset, uint16_t count,
+                uint8_t* dst);
+  bool readStart(uint32_t blockNumber);
+  bool readStop();
+  /** \return The SPI rate ID set by setSckRate() or autoSckRate(). */
+  uint8_t sckRate() const {return spiRate_;}
+  bool setSckRate(uint8_t sckRateID);
+  /** Return the card type: SD V1, SD V2 or SDHC
+   * \return 0 - SD V1, 1 - SD V2, or 3 - SDHC.
+   */
+  int type() const {return type_;}
+  bool writeBlock(uint32_t blockNumber, const uint8_t* src);
+  bool writeData(const uint8_t* src);
+  bool writeStart(uint32_t blockNumber, uint32_t eraseCount);
+  bool writeStop();
+
+ private:
+  //----------------------------------------------------------------------------
+  uint8_t chipSelectPin_;
+  uint8_t errorCode_;
+  uint8_t spiRate_;
+  uint8_t status_;
+  uint8_t type_;
+#if USE_HOST_SD_CARD
+  int fd_;                    // image file descriptor
+  uint32_t blockCount_;       // blocks in the image
+  uint32_t multiBlock_;       // next block of a multiple block sequence
+  uint32_t multiErased_;      // blocks left that were pre-erased by ACMD23
+  uint8_t multiState_;        // multiple block sequence in progress
+  SdHostLatency latency_;
+  SdHostStats stats_;
+  bool hostRead(uint32_t block, uint8_t* dst);
+  bool hostWrite(uint32_t block, const uint8_t* src, bool erased = false);
+  void modelDelay(uint32_t nanos);
+#endif  // USE_HOST_SD_CARD
+#if ASYNC_SD_QUEUE
+  // requests [asyncHead_, asyncHead_ + asyncCount_) are queued, the first
+  // asyncDone_ of them are finished
+  SdAsyncRequest async_[ASYNC_SD_QUEUE];
+  uint8_t asyncHead_;
+  uint8_t asyncCount_;
+  uint8_t asyncDone_;
+#if USE_HOST_SD_CARD
+  pthread_t asyncThread_;     // worker that runs the requests
+  pthread_mutex_t asyncMutex_;
+  pthread_cond_t asyncCond_;  // signaled when a request is added or done
+  bool asyncRun_;             // worker is running
+  static void* asyncWorker(void* arg);
+#else  // USE_HOST_SD_CARD
+  uint8_t asyncState_;        // phase of the oldest unfinished request
+  uint16_t asyncMillis_;      // start time of the phase
+  bool asyncStart(SdAsyncRequest* r);
+#endif  // USE_HOST_SD_CARD
+  bool asyncBegin(uint32_t block, uint8_t* buf, uint8_t write);
+#endif  // ASYNC_SD_QUEUE
+  // private functions
+  uint8_t cardAcmd(uint8_t cmd, uint32_t arg) {
+    cardCommand(CMD55, 0);
+    return cardCommand(cmd, arg);
+  }
+  uint8_t cardCommand(uint8_t cmd, uint32_t arg);
+  bool readCrc(uint32_t blockNumber, uint16_t* crc);
+  bool readData(uint8_t* dst, size_t count);
+  bool readRegister(uint8_t cmd, void* buf);
+  bool readSkip(uint16_t count, uint16_t* crc);
+  void chipSelectHigh();
+  void chipSelectLow();
+  void type(uint8_t value) {type_ = value;}
+  bool waitNotBusy(uint16_t timeoutMillis);
+  bool waitStartBlock();
+  bool writeData(uint8_t token, const uint8_t* src);
+};
+
 #endif  //Sd2Card_h
\ No newline at end of file
@@ -0,0 +1,585 @@
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ * Sd2Card for a Linux host.  The card is an image file and each command
+ * is charged the time given by the SdHostLatency model so read/write
+ * throughput can be measured without hardware.
+ */
+#include <Sd2Card.h>
+#if USE_HOST_SD_CARD
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+// state of a multiple block sequence
+static uint8_t const MULTI_NONE = 0;
+static uint8_t const MULTI_READ = 1;
+static uint8_t const MULTI_WRITE = 2;
+//------------------------------------------------------------------------------
+static uint64_t hostNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+//------------------------------------------------------------------------------
+/** \return ms since an arbitrary start, like the Arduino millis() */
+unsigned long millis() {
+  return hostNanos()/1000000;
+}
+//==============================================================================
+// Sd2Card member functions
+//------------------------------------------------------------------------------
+#if ASYNC_SD_QUEUE
+// add a request to the queue for the worker
+bool Sd2Card::asyncBegin(uint32_t block, uint8_t* buf, uint8_t write) {
+  bool rtn = false;
+  pthread_mutex_lock(&asyncMutex_);
+  if (!asyncRun_) {
+    error(SD_CARD_ERROR_INIT_NOT_CALLED);
+  } else if (asyncCount_ == ASYNC_SD_QUEUE) {
+    error(SD_CARD_ERROR_ASYNC_FULL);
+  } else {
+    SdAsyncRequest* r = &async_[(asyncHead_ + asyncCount_) % ASYNC_SD_QUEUE];
+    r->block = block;
+    r->buf = buf;
+    r->write = write;
+    r->status = 0;
+    asyncCount_++;
+    pthread_cond_broadcast(&asyncCond_);
+    rtn = true;
+  }
+  pthread_mutex_unlock(&asyncMutex_);
+  return rtn;
+}
+//------------------------------------------------------------------------------
+// Run queued requests in order.  The lock is not held during the transfer
+// and the latency model so the caller keeps working.
+void* Sd2Card::asyncWorker(void* arg) {
+  Sd2Card* card = reinterpret_cast<Sd2Card*>(arg);
+  pthread_mutex_lock(&card->asyncMutex_);
+  while (card->asyncRun_) {
+    if (card->asyncDone_ == card->asyncCount_) {
+      pthread_cond_wait(&card->asyncCond_, &card->asyncMutex_);
+      continue;
+    }
+    // complete() moves asyncHead_ and asyncDone_ together so r is stable
+    SdAsyncRequest* r = &card->async_[(card->asyncHead_ + card->asyncDone_)
+                                      % ASYNC_SD_QUEUE];
+    pthread_mutex_unlock(&card->asyncMutex_);
+    if (r->write) {
+      // CMD24 and the CMD13 status check
+      card->stats_.commands += 2;
+      card->modelDelay(2*card->latency_.commandNanos);
+      if (!card->hostWrite(r->block, r->buf)) r->status = SD_CARD_ERROR_CMD24;
+      card->modelDelay(card->latency_.busyNanos);
+    } else {
+      card->stats_.commands++;
+      card->modelDelay(card->latency_.commandNanos);
+      if (!card->hostRead(r->block, r->buf)) r->status = SD_CARD_ERROR_CMD17;
+    }
+    pthread_mutex_lock(&card->asyncMutex_);
+    card->asyncDone_++;
+    pthread_cond_broadcast(&card->asyncCond_);
+  }
+  pthread_mutex_unlock(&card->asyncMutex_);
+  return 0;
+}
+//------------------------------------------------------------------------------
+/**
+ * Start an asynchronous read of one block.  The block is read by a worker
+ * thread.
+ *
+ * \param[in] block Logical block to be read.
+ * \param[out] dst Buffer for the data.  It must not be used until
+ * complete() has returned for this request.
+ *
+ * Requests are done in the order they are begun.  No other Sd2Card
+ * function may be called while requests are queued.
+ *
+ * \return The value one, true, is returned for success and the value
+ * zero, false, is returned if ASYNC_SD_QUEUE requests are queued.
+ */
+bool Sd2Card::beginRead(uint32_t block, uint8_t* dst) {
+  return asyncBegin(block, dst, 0);
+}
+//------------------------------------------------------------------------------
+/**
+ * Start an asynchronous write of one block.  The block is written by a
+ * worker thread.
+ *
+ * \param[in] block Logical block to be written.
+ * \param[in] src Data to be written.  It must not be changed until
+ * complete() has returned for this request.
+ *
+ * \return The value one, true, is returned for success and the value
+ * zero, false, is returned if ASYNC_SD_QUEUE requests are queued.
+ */
+bool Sd2Card::beginWrite(uint32_t block, const uint8_t* src) {
+  return asyncBegin(block, const_cast<uint8_t*>(src), 1);
+}
+//------------------------------------------------------------------------------
+/**
+ * Wait for the oldest asynchronous request and remove it from the queue.
+ *
+ * \return The value one, true, is returned if the request succeeded or
+ * no request is queued.  The value zero, false, is returned if it failed.
+ */
+bool Sd2Card::complete() {
+  uint8_t status = 0;
+  pthread_mutex_lock(&asyncMutex_);
+  if (asyncCount_) {
+    while (asyncDone_ == 0) pthread_cond_wait(&asyncCond_, &asyncMutex_);
+    status = async_[asyncHead_].status;
+    asyncHead_ = (asyncHead_ + 1) % ASYNC_SD_QUEUE;
+    asyncCount_--;
+    asyncDone_--;
+  }
+  pthread_mutex_unlock(&asyncMutex_);
+  if (status) {
+    error(status);
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Check for finished requests without waiting.
+ *
+ * \return true if complete() will not wait.
+ */
+bool Sd2Card::poll() {
+  pthread_mutex_lock(&asyncMutex_);
+  bool rtn = asyncDone_ != 0 || asyncCount_ == 0;
+  pthread_mutex_unlock(&asyncMutex_);
+  return rtn;
+}
+#endif  // ASYNC_SD_QUEUE
+//------------------------------------------------------------------------------
+// spin for the time charged by the latency model
+void Sd2Card::modelDelay(uint32_t nanos) {
+  if (nanos == 0) return;
+#if ASYNC_SD_QUEUE
+  // the worker sleeps so the caller can use the time, even on one core
+  if (asyncRun_ && pthread_equal(pthread_self(), asyncThread_)) {
+    struct timespec ts = {0, (long)nanos};
+    nanosleep(&ts, 0);
+    stats_.modelNanos += nanos;
+    return;
+  }
+#endif  // ASYNC_SD_QUEUE
+  uint64_t t0 = hostNanos();
+  while ((hostNanos() - t0) < nanos) {}
+  stats_.modelNanos += nanos;
+}
+//------------------------------------------------------------------------------
+bool Sd2Card::hostRead(uint32_t block, uint8_t* dst) {
+  if (block >= blockCount_
+    || pread(fd_, dst, 512, (off_t)block << 9) != 512) {
+    return false;
+  }
+  stats_.blocksRead++;
+  modelDelay(latency_.blockNanos);
+  return true;
+}
+//------------------------------------------------------------------------------
+// a pre-erased block is charged only for the transfer
+bool Sd2Card::hostWrite(uint32_t block, const uint8_t* src, bool erased) {
+  if (block >= blockCount_
+    || pwrite(fd_, src, 512, (off_t)block << 9) != 512) {
+    return false;
+  }
+  stats_.blocksWritten++;
+  modelDelay(latency_.blockNanos + (erased ? 0 : latency_.programNanos));
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * The host card has no bus to tune.  The test block is read to check the
+ * image and the full rate is set.
+ *
+ * \param[in] blockNumber The test block.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::autoSckRate(uint32_t blockNumber) {
+  uint8_t buf[512];
+  if (!readBlock(blockNumber, buf)) return false;
+  spiRate_ = SPI_FULL_SPEED;
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Determine the size of the image file.
+ *
+ * \return The number of 512 byte data blocks in the image
+ *         or zero if an error occurs.
+ */
+uint32_t Sd2Card::cardSize() {
+  if (fd_ < 0) {
+    error(SD_CARD_ERROR_INIT_NOT_CALLED);
+    return 0;
+  }
+  return blockCount_;
+}
+//------------------------------------------------------------------------------
+/** Finish queued requests, stop the worker and close the image file. */
+void Sd2Card::end() {
+#if ASYNC_SD_QUEUE
+  if (asyncRun_) {
+    while (asyncCount_) complete();
+    pthread_mutex_lock(&asyncMutex_);
+    asyncRun_ = false;
+    pthread_cond_broadcast(&asyncCond_);
+    pthread_mutex_unlock(&asyncMutex_);
+    pthread_join(asyncThread_, 0);
+    pthread_cond_destroy(&asyncCond_);
+    pthread_mutex_destroy(&asyncMutex_);
+  }
+#endif  // ASYNC_SD_QUEUE
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+  blockCount_ = 0;
+  errorCode_ = SD_CARD_ERROR_INIT_NOT_CALLED;
+}
+//------------------------------------------------------------------------------
+/** Erase a range of blocks.
+ *
+ * \param[in] firstBlock The address of the first block in the range.
+ * \param[in] lastBlock The address of the last block in the range.
+ *
+ * \note Erased blocks read back as zero.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::erase(uint32_t firstBlock, uint32_t lastBlock) {
+  static const uint8_t zero[512] = {0};
+  stats_.commands += 3;
+  modelDelay(3*latency_.commandNanos);
+  if (firstBlock > lastBlock || lastBlock >= blockCount_) {
+    error(SD_CARD_ERROR_ERASE);
+    return false;
+  }
+  for (uint32_t b = firstBlock; b <= lastBlock; b++) {
+    if (pwrite(fd_, zero, 512, (off_t)b << 9) != 512) {
+      error(SD_CARD_ERROR_ERASE);
+      return false;
+    }
+  }
+  stats_.blocksErased += lastBlock - firstBlock + 1;
+  modelDelay(latency_.eraseNanos);
+  return true;
+}
+//------------------------------------------------------------------------------
+/** The host card always supports single block erase.
+ *
+ * \return The value one, true.
+ */
+bool Sd2Card::eraseSingleBlockEnable() {
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Reinitialize the card opened by init(const char*).
+ *
+ * \param[in] sckRateID SPI clock rate selector. See setSckRate().
+ * \param[in] chipSelectPin Not used by the host card.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin) {
+  chipSelectPin_ = chipSelectPin;
+  if (fd_ < 0) {
+    error(SD_CARD_ERROR_INIT_NOT_CALLED);
+    return false;
+  }
+  errorCode_ = 0;
+  multiState_ = MULTI_NONE;
+  if (sckRateID == SPI_AUTO_SPEED) return autoSckRate();
+  return setSckRate(sckRateID);
+}
+//------------------------------------------------------------------------------
+/**
+ * Open an image file as the card.
+ *
+ * \param[in] path Image file or block device.  Its size is rounded
+ * down to a multiple of 512 bytes.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::init(const char* path) {
+  end();
+  fd_ = open(path, O_RDWR);
+  if (fd_ < 0) {
+    error(SD_CARD_ERROR_CMD0);
+    return false;
+  }
+  // lseek also gives the size of a block device
+  off_t size = lseek(fd_, 0, SEEK_END);
+  if (size < 512) {
+    error(SD_CARD_ERROR_CMD0);
+    end();
+    return false;
+  }
+  blockCount_ = size >> 9;
+  type(SD_CARD_TYPE_SDHC);
+#if ASYNC_SD_QUEUE
+  asyncHead_ = asyncCount_ = asyncDone_ = 0;
+  pthread_mutex_init(&asyncMutex_, 0);
+  pthread_cond_init(&asyncCond_, 0);
+  asyncRun_ = true;
+  if (pthread_create(&asyncThread_, 0, asyncWorker, this)) {
+    asyncRun_ = false;
+    pthread_cond_destroy(&asyncCond_);
+    pthread_mutex_destroy(&asyncMutex_);
+  }
+#endif  // ASYNC_SD_QUEUE
+  return init(SPI_FULL_SPEED, SD_CHIP_SELECT_PIN);
+}
+//------------------------------------------------------------------------------
+/**
+ * Read a 512 byte block from the image.
+ *
+ * \param[in] blockNumber Logical block to be read.
+ * \param[out] dst Pointer to the location that will receive the data.
+
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readBlock(uint32_t blockNumber, uint8_t* dst) {
+  stats_.commands++;
+  modelDelay(latency_.commandNanos);
+  if (!hostRead(blockNumber, dst)) {
+    error(SD_CARD_ERROR_CMD17);
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Read part of a 512 byte block from the image.  The timing model charges
+ * a whole block, an SPI card sends all of it.
+ *
+ * \param[in] blockNumber Logical block to be read.
+ * \param[in] offset Number of bytes to skip at the start of the block.
+ * \param[in] count Number of bytes to read.
+ * \param[out] dst Pointer to the location that will receive the data.
+
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readPart(uint32_t blockNumber, uint16_t offset, uint16_t count,
+                       uint8_t* dst) {
+  stats_.commands++;
+  modelDelay(latency_.commandNanos);
+  if ((offset + count) > 512 || blockNumber >= blockCount_
+    || pread(fd_, dst, count, ((off_t)blockNumber << 9) + offset) != count) {
+    error(SD_CARD_ERROR_CMD17);
+    return false;
+  }
+  stats_.blocksRead++;
+  modelDelay(latency_.blockNanos);
+  return true;
+}
+//------------------------------------------------------------------------------
+/** Read one data block in a multiple block read sequence
+ *
+ * \param[in] dst Pointer to the location for the data to be read.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readData(uint8_t *dst) {
+  if (multiState_ != MULTI_READ || !hostRead(multiBlock_, dst)) {
+    error(SD_CARD_ERROR_READ);
+    return false;
+  }
+  multiBlock_++;
+  return true;
+}
+//------------------------------------------------------------------------------
+// synthesize a CSD/CID that matches the image
+bool Sd2Card::readRegister(uint8_t cmd, void* buf) {
+  stats_.commands++;
+  modelDelay(latency_.commandNanos);
+  memset(buf, 0, 16);
+  if (cmd == CMD9) {
+    csd2_t* csd = reinterpret_cast<csd2_t*>(buf);
+    uint32_t c_size = blockCount_ >> 10;
+    if (c_size) c_size--;
+    csd->csd_ver = 1;
+    csd->taac = 0X0E;
+    csd->tran_speed = 0X32;
+    csd->read_bl_len = 9;
+    csd->c_size_high = c_size >> 16;
+    csd->c_size_mid = c_size >> 8;
+    csd->c_size_low = c_size;
+    csd->erase_blk_en = 1;
+    csd->sector_size_high = 0X3F;
+    csd->sector_size_low = 1;
+    csd->write_bl_len_high = 2;
+    csd->write_bl_len_low = 1;
+    csd->r2w_factor = 2;
+    csd->always1 = 1;
+  } else if (cmd == CMD10) {
+    cid_t* cid = reinterpret_cast<cid_t*>(buf);
+    memcpy(cid->oid, "PF", 2);
+    memcpy(cid->pnm, "HOST ", 5);
+    cid->always1 = 1;
+  } else {
+    error(SD_CARD_ERROR_READ_REG);
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+/** Start a read multiple blocks sequence.
+ *
+ * \param[in] blockNumber Address of first block in sequence.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readStart(uint32_t blockNumber) {
+  stats_.commands++;
+  modelDelay(latency_.commandNanos);
+  if (blockNumber >= blockCount_) {
+    error(SD_CARD_ERROR_CMD18);
+    return false;
+  }
+  multiBlock_ = blockNumber;
+  multiState_ = MULTI_READ;
+  return true;
+}
+//------------------------------------------------------------------------------
+/** End a read multiple blocks sequence.
+ *
+* \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readStop() {
+  stats_.commands++;
+  modelDelay(latency_.commandNanos);
+  if (multiState_ != MULTI_READ) {
+    error(SD_CARD_ERROR_CMD12);
+    return false;
+  }
+  multiState_ = MULTI_NONE;
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Set the SPI clock rate.  The host card only checks the range, use
+ * setLatency() to change the modeled transfer time.
+ *
+ * \param[in] sckRateID A value in the range [0, 14].
+ *
+ * \return The value one, true, is returned for success and the value zero,
+ * false, is returned for an invalid value of \a sckRateID.
+ */
+bool Sd2Card::setSckRate(uint8_t sckRateID) {
+  if (sckRateID > MAX_SCK_RATE_ID) {
+    error(SD_CARD_ERROR_SCK_RATE);
+    return false;
+  }
+  spiRate_ = sckRateID;
+  return true;
+}
+//------------------------------------------------------------------------------
+/**
+ * Writes a 512 byte block to the image.
+ *
+ * \param[in] blockNumber Logical block to be written.
+ * \param[in] src Pointer to the location of the data to be written.
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::writeBlock(uint32_t blockNumber, const uint8_t* src) {
+  // CMD24 and the CMD13 status check
+  stats_.commands += 2;
+  modelDelay(2*latency_.commandNanos);
+  if (!hostWrite(blockNumber, src)) {
+    error(SD_CARD_ERROR_CMD24);
+    return false;
+  }
+  modelDelay(latency_.busyNanos);
+  return true;
+}
+//------------------------------------------------------------------------------
+/** Write one data block in a multiple block write sequence
+ * \param[in] src Pointer to the location of the data to be written.
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::writeData(const uint8_t* src) {
+  if (multiState_ != MULTI_WRITE
+    || !hostWrite(multiBlock_, src, multiErased_ != 0)) {
+    error(SD_CARD_ERROR_WRITE_MULTIPLE);
+    return false;
+  }
+  if (multiErased_) multiErased_--;
+  multiBlock_++;
+  return true;
+}
+//------------------------------------------------------------------------------
+/** Start a write multiple blocks sequence.
+ *
+ * \param[in] blockNumber Address of first block in sequence.
+ * \param[in] eraseCount The number of blocks to be pre-erased.  The model
+ * charges no program time for the first \a eraseCount blocks written.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::writeStart(uint32_t blockNumber, uint32_t eraseCount) {
+  // CMD55, ACMD23 and CMD25
+  stats_.commands += 3;
+  modelDelay(3*latency_.commandNanos);
+  if (blockNumber >= blockCount_) {
+    error(SD_CARD_ERROR_CMD25);
+    return false;
+  }
+  multiBlock_ = blockNumber;
+  multiErased_ = eraseCount;
+  multiState_ = MULTI_WRITE;
+  return true;
+}
+//------------------------------------------------------------------------------
+/** End a write multiple blocks sequence.
+ *
+* \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::writeStop() {
+  stats_.commands++;
+  modelDelay(latency_.commandNanos);
+  if (multiState_ != MULTI_WRITE) {
+    error(SD_CARD_ERROR_STOP_TRAN);
+    return false;
+  }
+  multiState_ = MULTI_NONE;
+  // the card is busy until the last block is programmed
+  modelDelay(latency_.busyNanos);
+  return true;
+}
+#endif  // USE_HOST_SD_CARD
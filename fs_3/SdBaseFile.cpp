@@ -1,894 +1,1645 @@
-/* Arduino PFS Library
- * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
- *
- * This file is part of the Arduino PFS Library
- *
- * This Library is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This Library is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with the Arduino PFS Library.  If not, see
- * <http://www.gnu.org/licenses/>.
- */
-#include <SdBaseFile.h>
-#include <SdPfs.h>
-
-SdBaseFile::SdBaseFile(const char* path, uint8_t oflag) {
-  type_ = PFS_FILE_TYPE_CLOSED;
-  open(path, oflag);
-}
-
-bool SdBaseFile::seek(uint32_t pos, uint8_t option){
-  if(option == SEEK_END_)
-    return seekEnd(pos);
-  else if(option == SEEK_CUR_)
-    return seekCur(pos);
-  else if(option == SEEK_BEG_)
-    return seekSet(pos);
-  else
-    return false;
-}
-
-#define DBG_FAIL_MACRO  //  Serial.print(__FILE__);Serial.println(__LINE__)
-
-SdBaseFile* SdBaseFile::cwd_ = 0;
-
-void SdBaseFile::getpos(PfsPos_t* pos) {
-  pos->position = curPosition_;
-  pos->cluster = curCluster_;
-}
-
-void SdBaseFile::setpos(PfsPos_t* pos) {
-  pos->position = curPosition_;
-  pos->cluster = curCluster_;
-}
-
-bool SdBaseFile::sync() {
-  #if ENABLED_READ_ONLY
-  return true;
-  #else
-  // only allow open files and directories
-  if (!isOpen()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (flags_ & F_FILE_DIR_DIRTY) {
-    dir_t* d = cacheDirEntry(SdVolume::CACHE_FOR_WRITE);
-    // check for deleted by another open file object
-    if (!d || d->name[0] == DIR_NAME_DELETED) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    // do not set filesize for dir files
-    if (!isDir()) d->fileSize = fileSize_;
-    // clear directory dirty
-    flags_ &= ~F_FILE_DIR_DIRTY;
-  }
-  return vol_->cacheSync();
-
- fail:
-  return false;
-  #endif
-}
-
-dir_t* SdBaseFile::cacheDirEntry(uint8_t action) {
-  cache_t* pc;
-  pc = vol_->cacheFetch(dirBlock_, action);
-  if (!pc) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  return pc->dir + dirIndex_;
-
- fail:
-  return 0;
-}
-
-bool SdBaseFile::open(const char* path, uint8_t oflag) {
-  return open(cwd_, path, oflag);
-}
-
-bool SdBaseFile::make83Name(const char* str, char* name, const char** ptr) {
-  uint8_t c;
-  uint8_t n = 7;  
-  uint8_t i = 0;
-
-  while (i < 11) name[i++] = 0;
-
-  i = 0;
-  while (*str != '\0' && *str != '/') {
-    c = *str++;
-    if (c == '.') {
-      while(i < 8) name[i++] = ' ';
-      if (n == 10) {
-        // only one dot allowed
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-      n = 10; 
-      i = 8;   
-    } else {
-
-#ifdef __AVR__
-      // store chars in flash
-      PGM_P p = PSTR("|<>^+=?/[];,*\"\\");
-      uint8_t b;
-      while ((b = pgm_read_byte(p++))) if (b == c) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-#else  // __AVR__
-      // store chars in RAM
-      if (strchr("|<>^+=?/[];,*\"\\", c)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-#endif  // __AVR__
-
-      if (i > n || c < 0X21 || c > 0X7E) { //solo caracteres imprimibles.
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-      // se guardan siempre en mayusculas
-      name[i++] = c < 'a' || c > 'z' ?  c : c + ('A' - 'a');
-    }
-  }
-  *ptr = str;
-  return name[0] != ' ' && name[0] != 0;
-
- fail:
-  return false;
-}
-
-bool SdBaseFile::exists(const char* name) {
-  SdBaseFile file;
-  return file.open(this, name, O_READ);
-}
-
-bool SdBaseFile::open(SdBaseFile* dirFile, const char* path, uint8_t oflag) {
-  char dname[11];
-  SdBaseFile dir1, dir2;
-  SdBaseFile *parent = dirFile;
-  SdBaseFile *sub = &dir1;
-
-  if (!dirFile) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (isOpen()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (*path == '/') {
-    while (*path == '/') path++;
-    if (!dirFile->isRoot()) {
-      if (!dir2.openRoot(dirFile->vol_)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-      parent = &dir2;
-    }
-  }
-  if(!make83Name(path, dname, &path)){
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  while(!*path == '/') path++;
-  /* just level 1 directories allowed*/
-  if(!parent->isRoot() && *path !=0){
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  return open(parent, dname, oflag);  
-
- fail:
-  return false;
-}
-
-dir_t* SdBaseFile::readDirCache() {
-  uint8_t i;
-  // error if not directory
-  if (!isDir()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // index of entry in cache
-  i = (curPosition_ >> 5) & 0XF;
-
-  // use read to locate and cache block
-  if (read() < 0) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // advance to next entry
-  curPosition_ += 31;
-
-  // return pointer to entry
-  return vol_->cacheAddress()->dir + i;
-
- fail:
-  return 0;
-}
-
-bool SdBaseFile::addCluster() {
-  if (!vol_->allocContiguous(1, &curCluster_)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // if first cluster of file link to directory entry
-  if (firstCluster_ == 0) {
-    firstCluster_ = curCluster_;
-    flags_ |= F_FILE_DIR_DIRTY;
-  }
-  return true;
-
- fail:
-  return false;
-}
-
-bool SdBaseFile::openCachedEntry(uint8_t dirIndex, uint8_t oflag) {
-  // location of entry in cache
-  dir_t* p = &vol_->cacheAddress()->dir[dirIndex];
-
-  // write or truncate is an error for a directory or read-only file
-  if (p->attributes & (DIR_ATT_READ_ONLY | DIR_ATT_DIRECTORY)) {
-    if (oflag & O_WRITE) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-  }
-  // remember location of directory entry on SD
-  dirBlock_ = vol_->cacheBlockNumber();
-  dirIndex_ = dirIndex;
-
-  // copy first cluster number for directory fields
-  firstCluster_ = p->firstCluster;
-
-  // make sure it is a normal file or subdirectory
-  if (DIR_IS_FILE(p)) {
-    fileSize_ = p->fileSize;
-    type_ = PFS_FILE_TYPE_NORMAL;
-  } else if (DIR_IS_SUBDIR(p)) {
-    if (!setDirSize()) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    type_ = PFS_FILE_TYPE_SUBDIR;
-  } else {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // save open flags for read/write
-  flags_ = oflag & F_OFLAG;
-
-  // set to start of file
-  curCluster_ = 0;
-  curPosition_ = 0;
-  return true;
-
- fail:
-  type_ = PFS_FILE_TYPE_CLOSED;
-  return false;
-}
-
-bool SdBaseFile::open(SdBaseFile* dirFile, const uint8_t dname[11], uint8_t oflag) {
-  cache_t* pc;
-  uint8_t i;
-
-  bool emptyFound = false;
-  bool fileFound = false;  
-  dir_t* p;
-  
-  if(dirFile->isFile()) goto fail;
-
-  vol_ = dirFile->vol_;
-
-  //porque hay que buscar secuencialmente
-  dirFile->rewind();
-
-  while (dirFile->curPosition_ < dirFile->fileSize_) {
-    i = (dirFile->curPosition_ >> 5) & 0XF;
-    p = dirFile->readDirCache();
-    if (!p) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if(p->name[0] == DIR_NAME_FREE || p->name[0] == DIR_NAME_DELETED){
-      if (!emptyFound) {
-        emptyFound = true;
-        dirBlock_ = vol_->cacheBlockNumber();
-        dirIndex_ = i;        
-      }
-      // done if no entries follow
-      if (p->name[0] == DIR_NAME_FREE) break;
-    }else{
-      if(memcmp(p->name, dname, 11)==0){
-        fileFound = true;
-        break;
-      }
-    }
-  }
-  
-  if(!fileFound){
-    if((oflag & O_CREAT) || (oflag & O_WRITE)){
-      #if !ENABLED_READ_ONLY      
-      if(emptyFound){
-        p = cacheDirEntry(SdVolume::CACHE_FOR_WRITE);
-        i = dirIndex_;
-      }else{
-        pc = dirFile->addDirCluster();
-        if (!pc) {
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-        i = 0;
-        p = pc->dir;
-        memset(p, 0, sizeof(dir_t));
-        memcpy(p->name, dname, 11);
-      }
-      #endif
-    }    
-  }  
-  return openCachedEntry(i, oflag);  
-
- fail:
-  return false;
-}
-
-bool SdBaseFile::openRoot(SdVolume* vol) {
-  if (isOpen()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  vol_ = vol;
-  type_ = PFS_FILE_TYPE_ROOT32;
-  firstCluster_ = vol->rootDirStart();
-  if (!setDirSize()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  flags_ = O_RDONLY;
-
-  dirBlock_ = firstCluster_;
-  dirIndex_ = 0;
-
-  curCluster_ = 0;
-  curPosition_ = 0;  
-  return true;
-
- fail:
-  return false;
-}
-
-bool SdBaseFile::openNext(SdBaseFile* dirFile, uint8_t oflag){
-  if (!dirFile || isOpen()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  vol_ = dirFile->vol_;
-
-  dir_t* p;
-  uint8_t i;
-
-  do{
-    if(!(p = dirFile->readDirCache())){
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if (p->name[0] == DIR_NAME_FREE) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if (p->name[0] == DIR_NAME_DELETED || p->name[0] == '.') {
-      continue;
-    }
-    i = (dirFile->curPosition_ >> 5) & 0XF;
-    if (DIR_IS_FILE_OR_SUBDIR(p))
-      return openCachedEntry(i, oflag);
-  }while(true);
-  
- fail:
-  return false;
-}
-
-bool SdBaseFile::close() {
-  bool res = sync();
-  type_ = PFS_FILE_TYPE_CLOSED;
-  return res;
-}
-
-#if !ENABLED_READ_ONLY
-int SdBaseFile::write(const void* buf, size_t nbyte) {
-  // convert void* to uint8_t*  -  must be before goto statements
-  const uint8_t* src = reinterpret_cast<const uint8_t*>(buf);
-  cache_t* pc;
-  uint8_t cacheOption;
-  // number of bytes left to write  -  must be before goto statements
-  size_t nToWrite = nbyte;
-  size_t n;
-  // error if not a normal file or is read-only
-  if (!isFile() || !(flags_ & O_WRITE)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-
-  while (nToWrite) {
-    uint8_t blockOfCluster = vol_->blockOfCluster(curPosition_);
-    uint16_t blockOffset = curPosition_ & 0X1FF;
-    if (blockOfCluster == 0 && blockOffset == 0) {
-      // start of new cluster
-      if (curCluster_ != 0) {
-        uint32_t next;
-        if (!vol_->pfsGet(curCluster_, &next)) {
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-        if (vol_->isEOC(next)) {
-          // add cluster if at end of chain
-          if (!addCluster()) {
-            DBG_FAIL_MACRO;
-            goto fail;
-          }
-        } else {
-          curCluster_ = next;
-        }
-      } else {
-        if (firstCluster_ == 0) {
-          // allocate first cluster of file
-          if (!addCluster()) {
-            DBG_FAIL_MACRO;
-            goto fail;
-          }
-        } else {
-          curCluster_ = firstCluster_;
-        }
-      }
-    }
-    // block for data write
-    uint32_t block = vol_->clusterStartBlock(curCluster_) + blockOfCluster;
-
-    if (blockOffset != 0 || nToWrite < 512) {
-      // partial block - must use cache
-      // max space in block
-      n = 512 - blockOffset;
-      // lesser of space and amount to write
-      if (n > nToWrite) n = nToWrite;
-
-      if (blockOffset == 0 && curPosition_ >= fileSize_) {
-        // start of new block don't need to read into cache
-        cacheOption = SdVolume::CACHE_RESERVE_FOR_WRITE;
-      } else {
-        // rewrite part of block
-        cacheOption = SdVolume::CACHE_FOR_WRITE;
-        }
-        pc = vol_->cacheFetch(block, cacheOption);
-        if (!pc) {
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-      uint8_t* dst = pc->data + blockOffset;
-      memcpy(dst, src, n);
-      if (512 == (n + blockOffset)) {
-        if (!vol_->cacheWriteData()) {
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-      }
-    } else if (!USE_MULTI_BLOCK_SD_IO || nToWrite < 1024) {
-      // use single block write command
-      n = 512;
-      if (vol_->cacheBlockNumber() == block) {
-        vol_->cacheInvalidate();
-      }
-      if (!vol_->writeBlock(block, src)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    curPosition_ += n;
-    src += n;
-    nToWrite -= n;
-  }
-  if (curPosition_ > fileSize_) {
-    // update fileSize and insure sync will update dir entry
-    fileSize_ = curPosition_;
-    flags_ |= F_FILE_DIR_DIRTY;
-  }
-  if (!sync()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  return nbyte;
-
- fail:
-  return -1;
-}
-
-bool SdBaseFile::rmdir() {
-  // must be open subdirectory
-  if (!isSubDir()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  rewind();
-
-  // make sure directory is empty
-  while (curPosition_ < fileSize_) {
-    dir_t* p = readDirCache();
-    if (!p) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    // done if past last used entry
-    if (p->name[0] == DIR_NAME_FREE) break;
-    // skip empty slot, '.' or '..'
-    if (p->name[0] == DIR_NAME_DELETED || p->name[0] == '.') continue;
-    // error not empty
-    if (DIR_IS_FILE_OR_SUBDIR(p)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-  }
-  // convert empty directory to normal file for remove
-  type_ = PFS_FILE_TYPE_NORMAL;
-  flags_ |= O_WRITE;
-  return remove();
-
- fail:
-  return false;
-}
-
-cache_t* SdBaseFile::addDirCluster() {
-  uint32_t block;
-  cache_t* pc;
-  // max folder size
-  if (fileSize_/sizeof(dir_t) >= 0XFFFF) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (!addCluster()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  block = vol_->clusterStartBlock(curCluster_);
-  pc = vol_->cacheFetch(block, SdVolume::CACHE_RESERVE_FOR_WRITE);
-  if (!pc) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  memset(pc, 0, 512);
-  // zero rest of clusters
-  for (uint8_t i = 1; i < vol_->blocksPerCluster_; i++) {
-    if (!vol_->writeBlock(block + i, pc->data)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-  }
-  // Increase directory file size by cluster size
-  fileSize_ += 512UL*vol_->blocksPerCluster_;
-  return pc;
-
- fail:
-  return 0;
-}
-
-bool SdBaseFile::remove(SdBaseFile* dirFile, const char* path) {
-  SdBaseFile file;
-  if (!file.open(dirFile, path, O_WRITE)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  return file.remove();
-
- fail:
-  return false;
-}
-
-bool SdBaseFile::remove() {
-  dir_t* d;
-  // free any clusters - will fail if read-only or directory
-  if (!truncate()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // cache directory entry
-  d = cacheDirEntry(SdVolume::CACHE_FOR_WRITE);
-  if (!d) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // mark entry deleted
-  d->name[0] = DIR_NAME_DELETED;
-
-  // set this file closed
-  type_ = PFS_FILE_TYPE_CLOSED;
-
-  // write entry to SD
-  return vol_->cacheSync();
-  return true;
-
- fail:
-  return false;
-}
-
-bool SdBaseFile::mkdir(SdBaseFile* dir, const char dname[11]){
-  if(!dir->isRoot()){
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  char new_dir[11];
-  if (!make83Name(dname, new_dir, &dname)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (!open(dir, dname, O_CREAT | O_RDWR)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  type_ = PFS_FILE_TYPE_SUBDIR;
-  flags_ = O_READ;
-  //ya es un directorio, ahora hay que agregar la referencia (dir_t) para . y ..
-
-  if (!addDirCluster()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (!sync()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  dir_t* p;
-  dir_t dots;
-
-  if((p = cacheDirEntry(SdVolume::CACHE_FOR_WRITE)) == 0){
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  p->attributes = DIR_ATT_DIRECTORY;
-  
-  memcpy(&dots, p, sizeof(dots));
-  memcpy(&dots.name, ".", 11);
-  dots.firstCluster = 0;
-
-  return true;
- fail:
-  return false;
-}
-
-bool SdBaseFile::truncate() {
-  uint32_t newPos;
-  // error if not a normal file or read-only
-  if (!isFile() || !(flags_ & O_WRITE)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-
-  // fileSize and length are zero - nothing to do
-  if (fileSize_ == 0) return true;
-
-  // remember position for seek after truncation
-  newPos = 0;
-
-  // free all clusters
-  if (!vol_->freeChain(firstCluster_)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  firstCluster_ = 0;
-  
-  fileSize_ = 0;
-
-  // need to update directory entry
-  flags_ |= F_FILE_DIR_DIRTY;
-
-  if (!sync()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // set file to correct position
-  return seekSet(0);
-
- fail:
-  return false;
-}
-#endif
-
-bool SdBaseFile::seekSet(uint32_t pos) {
-  uint32_t nCur;
-  uint32_t nNew;
-
-  if (!isOpen() || pos > fileSize_) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (type_ == PFS_FILE_TYPE_ROOT_FIXED) {
-    curPosition_ = pos;
-    goto done;
-  }
-  if (pos == 0) {
-    curCluster_ = 0;
-    curPosition_ = 0;
-    goto done;
-  }else{
-	  curCluster_ = pos/512L;
-	  curPosition_ = pos % 512L;
-  }
- done:
-  return true;
-
- fail:
-  return false;
-}
-
-int SdBaseFile::peek() {
-  PfsPos_t pos;
-  getpos(&pos);
-  int c = read();
-  if (c >= 0) setpos(&pos);
-  return c;
-}
-
-bool SdBaseFile::setDirSize() {
-  uint16_t s = 0;
-  uint32_t cluster = firstCluster_;
-  do {
-    if (!vol_->pfsGet(cluster, &cluster)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    s += vol_->blocksPerCluster();
-    // max size if a directory file is 4096 blocks
-    if (s >= 4096) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-  } while (!vol_->isEOC(cluster));
-  fileSize_ = 512L*s;
-  return true;
-
- fail:
-  return false;
-}
-
-void SdBaseFile::dirName(const dir_t& dir, char* name) {
-  uint8_t j = 0;
-  for (uint8_t i = 0; i < 11; i++) {
-    if (dir.name[i] == ' ')continue;
-    if (i == 8) name[j++] = '.';
-    name[j++] = dir.name[i];
-  }
-  name[j] = 0;
-}
-
-bool SdBaseFile::getFilename(char* name) {
-  dir_t* p;
-  if (!isOpen()) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  if (isRoot()) {
-    name[0] = '/';
-    name[1] = '\0';
-    return true;
-  }
-  // cache entry
-  p = cacheDirEntry(SdVolume::CACHE_FOR_READ);
-  if (!p) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // format name
-  dirName(*p, name);
-  return true;
-
- fail:
-  return false;
-}
-
-int16_t SdBaseFile::read() {
-  uint8_t b;
-  return read(&b, 1) == 1 ? b : -1;
-}
-
-int SdBaseFile::read(void* buf, size_t nbyte) {
-  uint8_t blockOfCluster;
-  uint8_t* dst = reinterpret_cast<uint8_t*>(buf);
-  uint16_t offset;
-  size_t toRead;
-  uint32_t block;  // raw device block number
-  cache_t* pc;
-
-  // error if not open or write only
-  if (!isOpen() || !(flags_ & O_READ)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // max bytes left in file
-  if (nbyte >= (fileSize_ - curPosition_)) {
-    nbyte = fileSize_ - curPosition_;
-  }
-  // amount left to read
-  toRead = nbyte;
-  while (toRead > 0) {
-    size_t n;
-    offset = curPosition_ & 0X1FF;  // offset in block
-    blockOfCluster = vol_->blockOfCluster(curPosition_);
-
-    if (offset == 0 && blockOfCluster == 0) {
-      // start of new cluster
-      if (curPosition_ == 0) {
-        // use first cluster in file
-        curCluster_ = firstCluster_;
-      } else {
-        // get next cluster from FAT
-        if (!vol_->pfsGet(curCluster_, &curCluster_)) {
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-      }
-    }
-    block = vol_->clusterStartBlock(curCluster_) + blockOfCluster;
-    
-    if (offset != 0 || toRead < 512 || block == vol_->cacheBlockNumber()) {
-      // amount to be read from current block
-      n = 512 - offset;
-      if (n > toRead) n = toRead;
-      // read block to cache and copy data to caller
-      pc = vol_->cacheFetch(block, SdVolume::CACHE_FOR_READ);
-      if (!pc) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-      uint8_t* src = pc->data + offset;
-      memcpy(dst, src, n);
-    } else if (!USE_MULTI_BLOCK_SD_IO || toRead < 1024) {
-      // read single block
-      n = 512;
-      if (!vol_->readBlock(block, dst)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    } else {
-      uint8_t nb = toRead >> 9;
-
-      n = 512*nb;
-      if (vol_->cacheBlockNumber() <= block
-        && block < (vol_->cacheBlockNumber() + nb)) {
-        // flush cache if a block is in the cache
-        if (!vol_->cacheSync()) {
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-      }
-      if (!vol_->sdCard()->readStart(block)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-      for (uint8_t b = 0; b < nb; b++) {
-        if (!vol_->sdCard()->readData(dst + b*512)) {
-          DBG_FAIL_MACRO;
-          goto fail;
-        }
-      }
-      if (!vol_->sdCard()->readStop()) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    dst += n;
-    curPosition_ += n;
-    toRead -= n;
-  }
-  return nbyte;
-
- fail:
-  return -1;
-}
-
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <SdBaseFile.h>
+
+SdBaseFile::SdBaseFile(const char* path, uint8_t oflag) {
+  type_ = PFS_FILE_TYPE_CLOSED;
+  open(path, oflag);
+}
+
+bool SdBaseFile::seek(uint32_t pos, uint8_t option){
+  if(option == SEEK_END_)
+    return seekEnd(pos);
+  else if(option == SEEK_CUR_)
+    return seekCur(pos);
+  else if(option == SEEK_BEG_)
+    return seekSet(pos);
+  else
+    return false;
+}
+
+#define DBG_FAIL_MACRO  //  Serial.print(__FILE__);Serial.println(__LINE__)
+
+SdBaseFile* SdBaseFile::cwd_ = 0;
+
+void SdBaseFile::getpos(PfsPos_t* pos) {
+  pos->position = curPosition_;
+  pos->cluster = curCluster_;
+}
+
+void SdBaseFile::setpos(PfsPos_t* pos) {
+  curPosition_ = pos->position;
+  curCluster_ = pos->cluster;
+}
+
+bool SdBaseFile::sync() {
+  #if ENABLED_READ_ONLY
+  return true;
+  #else
+  // only allow open files and directories
+  if (!isOpen() || !syncDirEntry()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  syncBytes_ = 0;
+  return vol_->sync();
+
+ fail:
+  return false;
+  #endif
+}
+
+// Copy the size and allocation to the cached directory entry if changed.
+bool SdBaseFile::syncDirEntry() {
+  if (flags_ & F_FILE_DIR_DIRTY) {
+    dir_t* d = cacheDirEntry(SdVolume::CACHE_FOR_LOG);
+    // check for deleted by another open file object
+    if (!d || d->name[0] == DIR_NAME_DELETED) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // do not set filesize for dir files
+    if (!isDir()) d->fileSize = fileSize_;
+    d->firstCluster = firstCluster_;
+    if (isDir()) {
+      d->clusterCount = clusterIndex(fileSize_);
+    } else if (isContiguous()) {
+      d->pfsFlags |= DIR_PFS_CONTIGUOUS;
+      d->clusterCount = extent_[0].count;
+    } else {
+      d->pfsFlags &= ~DIR_PFS_CONTIGUOUS;
+      d->clusterCount = 0;
+    }
+    // clear directory dirty
+    flags_ &= ~F_FILE_DIR_DIRTY;
+  }
+  return true;
+
+ fail:
+  return false;
+}
+
+dir_t* SdBaseFile::cacheDirEntry(uint8_t action) {
+  cache_t* pc;
+  pc = vol_->cacheFetch(dirBlock_, action);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // the entry is changed by the caller
+  if (action & SdVolume::CACHE_STATUS_LOGGED) {
+    vol_->cacheLog(vol_->cacheCurrent_, 32*dirIndex_, 32);
+  }
+  return pc->dir + dirIndex_;
+
+ fail:
+  return 0;
+}
+
+bool SdBaseFile::open(const char* path, uint8_t oflag) {
+  return open(cwd_, path, oflag);
+}
+
+bool SdBaseFile::make83Name(const char* str, char* name, const char** ptr) {
+  uint8_t c;
+  uint8_t n = 7;  
+  uint8_t i = 0;
+
+  while (i < 11) name[i++] = 0;
+
+  i = 0;
+  while (*str != '\0' && *str != '/') {
+    c = *str++;
+    if (c == '.') {
+      while(i < 8) name[i++] = ' ';
+      if (n == 10) {
+        // only one dot allowed
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      n = 10; 
+      i = 8;   
+    } else {
+
+#ifdef __AVR__
+      // store chars in flash
+      PGM_P p = PSTR("|<>^+=?/[];,*\"\\");
+      uint8_t b;
+      while ((b = pgm_read_byte(p++))) if (b == c) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+#else  // __AVR__
+      // store chars in RAM
+      if (strchr("|<>^+=?/[];,*\"\\", c)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+#endif  // __AVR__
+
+      if (i > n || c < 0X21 || c > 0X7E) { //solo caracteres imprimibles.
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      // se guardan siempre en mayusculas
+      name[i++] = c < 'a' || c > 'z' ?  c : c + ('A' - 'a');
+    }
+  }
+  *ptr = str;
+  return name[0] != ' ' && name[0] != 0;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::exists(const char* name) {
+  SdBaseFile file;
+  return file.open(this, name, O_READ);
+}
+
+// Copy up to count file and subdirectory entries that follow the current
+// position.  Return the number copied, zero at the end of the directory
+// or -1 for an error.  Nothing is opened, so the size of a subdirectory
+// whose entry has no cluster count is zero rather than found by following
+// its chain as open() does.
+int SdBaseFile::readdir(PfsDirent_t* ent, uint16_t count) {
+  int n = 0;
+  if (!isDir()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  while (n < count && curPosition_ < fileSize_) {
+    dir_t* p = readDirCache();
+    if (!p) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // done if past last used entry
+    if (p->name[0] == DIR_NAME_FREE) {
+      curPosition_ = fileSize_;
+      break;
+    }
+    // skip deleted entry, '.' and '..'
+    if (p->name[0] == DIR_NAME_DELETED || p->name[0] == '.') continue;
+    if (!DIR_IS_FILE_OR_SUBDIR(p)) continue;
+    dirName(*p, ent->name);
+    ent->attributes = p->attributes;
+    ent->fileSize = DIR_IS_SUBDIR(p) ?
+      p->clusterCount << (9 + vol_->clusterSizeShift()) : p->fileSize;
+    ent->firstCluster = p->firstCluster;
+    ent++;
+    n++;
+  }
+  return n;
+
+ fail:
+  return -1;
+}
+
+#if USING_APP
+void SdBaseFile::ls(Print* pr, uint8_t flags, uint8_t indent) {
+  dir_t* p;
+  rewind();
+  while (curPosition_ < fileSize_) {
+    uint8_t i = (curPosition_ >> 5) & 0XF;
+    if (!(p = readDirCache())) return;
+    // done if past last used entry
+    if (p->name[0] == DIR_NAME_FREE) return;
+    // skip deleted entry, '.' and '..'
+    if (p->name[0] == DIR_NAME_DELETED || p->name[0] == '.') continue;
+    if (!DIR_IS_FILE_OR_SUBDIR(p)) continue;
+
+    char name[13];
+    dirName(*p, name);
+    for (uint8_t n = 0; n < indent; n++) pr->write(' ');
+    pr->print(name);
+    if (DIR_IS_SUBDIR(p)) pr->write('/');
+    if ((flags & LS_SIZE) && DIR_IS_FILE(p)) {
+      pr->write(' ');
+      pr->print(p->fileSize);
+    }
+    pr->println();
+    if ((flags & LS_R) && DIR_IS_SUBDIR(p)) {
+      // entry is still the current cache block
+      uint32_t pos = curPosition_;
+      SdBaseFile sub;
+      sub.vol_ = vol_;
+      if (sub.openCachedEntry(i, O_READ)) sub.ls(pr, flags, indent + 2);
+      if (!seekSet(pos)) return;
+    }
+  }
+}
+#endif  // USING_APP
+
+bool SdBaseFile::open(SdBaseFile* dirFile, const char* path, uint8_t oflag) {
+  char dname[11];
+  SdBaseFile dir1, dir2;
+  SdBaseFile *parent = dirFile;
+  SdBaseFile *sub = &dir1;
+
+  if (!dirFile) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (isOpen()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (*path == '/') {
+    while (*path == '/') path++;
+    if (!dirFile->isRoot()) {
+      if (!dir2.openRoot(dirFile->vol_)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      parent = &dir2;
+    }
+  }
+  if(!make83Name(path, dname, &path)){
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  while (*path == '/') path++;
+  /* just level 1 directories allowed*/
+  if(!parent->isRoot() && *path !=0){
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  return open(parent, reinterpret_cast<uint8_t*>(dname), oflag);
+
+ fail:
+  return false;
+}
+
+#if DIR_HASH_SIZE
+// Hash the names in this directory.  The hash is marked full if the
+// directory has too many entries.
+bool SdBaseFile::dirHashBuild() {
+  bool freeFound = false;
+  vol_->dirHashClear(firstCluster_);
+  rewind();
+  while (curPosition_ < fileSize_ && vol_->dirHashed(firstCluster_)) {
+    uint32_t entry = curPosition_ >> 5;
+    dir_t* p = readDirCache();
+    if (!p) {
+      vol_->dirHashClear(0);
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (p->name[0] == DIR_NAME_FREE || p->name[0] == DIR_NAME_DELETED) {
+      if (!freeFound) {
+        freeFound = true;
+        vol_->dirHashFree_ = entry;
+      }
+      // no entries follow
+      if (p->name[0] == DIR_NAME_FREE) break;
+    } else {
+      vol_->dirHashInsert(p->name, entry);
+    }
+  }
+  if (!freeFound) vol_->dirHashFree_ = fileSize_ >> 5;
+  return true;
+
+ fail:
+  return false;
+}
+#endif  // DIR_HASH_SIZE
+
+// Return the entry at curPosition_ and advance to the next entry.  The
+// directory block is fetched when its first entry is read, or again if
+// another block has replaced it as the current cache block.
+dir_t* SdBaseFile::readDirCache() {
+  uint8_t i;
+  uint8_t blockOfCluster;
+  uint32_t block;
+  // error if not directory or at end of directory
+  if (!isDir() || curPosition_ >= fileSize_) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // index of entry in cache
+  i = (curPosition_ >> 5) & 0XF;
+  blockOfCluster = vol_->blockOfCluster(curPosition_);
+  if (i == 0 && blockOfCluster == 0) {
+    // start of new cluster
+    if (curPosition_ == 0) {
+      curCluster_ = firstCluster_;
+    } else if (!vol_->pfsGet(curCluster_, &curCluster_)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    extentAdd(clusterIndex(curPosition_), curCluster_);
+  }
+  block = vol_->clusterStartBlock(curCluster_) + blockOfCluster;
+  if (vol_->cacheBlockNumber() != block) {
+    if (!vol_->cacheFetch(block, SdVolume::CACHE_FOR_READ)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  // advance to next entry
+  curPosition_ += 32;
+
+  // return pointer to entry
+  return vol_->cacheAddress()->dir + i;
+
+ fail:
+  return 0;
+}
+
+bool SdBaseFile::addCluster() {
+  uint32_t last = curCluster_;
+#if PFS_JOURNAL
+  // The first cluster is linked to the entry in the same transaction, else
+  // a commit for another file would leave it unreferenced.  The entry is
+  // fetched first so no commit is forced in between.
+  dir_t* d;
+  if (firstCluster_ == 0 && !cacheDirEntry(SdVolume::CACHE_FOR_READ)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#endif  // PFS_JOURNAL
+  if (!vol_->allocContiguous(1, &curCluster_)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // a contiguous file stays one run only if the cluster follows its last
+  if (isContiguous() && curCluster_ != (last + 1)) {
+    flags_ &= ~F_CONTIGUOUS;
+    flags_ |= F_FILE_DIR_DIRTY;
+  }
+  // if first cluster of file link to directory entry
+  if (firstCluster_ == 0) {
+    firstCluster_ = curCluster_;
+    flags_ |= F_FILE_DIR_DIRTY;
+#if PFS_JOURNAL
+    d = cacheDirEntry(SdVolume::CACHE_FOR_LOG);
+    if (!d) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    d->firstCluster = firstCluster_;
+#endif  // PFS_JOURNAL
+  }
+  return true;
+
+ fail:
+  return false;
+}
+
+// Find the run of blocks on the volume that starts at blockOfCluster in
+// curCluster_.  The run continues into following clusters of the chain
+// while they are adjacent on the volume.  If alloc is true, clusters are
+// added at the end of the chain as needed.
+bool SdBaseFile::contiguousRun(uint8_t blockOfCluster, uint32_t maxBlocks,
+                               bool alloc, uint32_t* count,
+                               uint32_t* lastCluster) {
+  uint32_t nb = vol_->blocksPerCluster() - blockOfCluster;
+  uint32_t cluster = curCluster_;
+  while (nb < maxBlocks) {
+    uint32_t next;
+    if (isContiguous() &&
+        (cluster + 1) < (extent_[0].cluster + extent_[0].count)) {
+      // no table access inside a contiguous file
+      cluster++;
+      nb += vol_->blocksPerCluster();
+      continue;
+    }
+    if (!vol_->pfsGet(cluster, &next)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (vol_->isEOC(next)) {
+      if (!alloc) break;
+      // link a new cluster, allocContiguous tries cluster + 1 first
+      next = cluster;
+      if (!vol_->allocContiguous(1, &next)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      if (isContiguous() && next != (cluster + 1)) {
+        flags_ &= ~F_CONTIGUOUS;
+        flags_ |= F_FILE_DIR_DIRTY;
+      }
+    }
+    if (next != (cluster + 1)) break;
+    cluster = next;
+    nb += vol_->blocksPerCluster();
+  }
+  *count = nb < maxBlocks ? nb : maxBlocks;
+  *lastCluster = cluster;
+  return true;
+
+ fail:
+  return false;
+}
+
+// Record that cluster index of the chain is cluster and that the next
+// count - 1 clusters of the chain follow it on the volume.
+void SdBaseFile::extentAdd(uint32_t index, uint32_t cluster, uint32_t count) {
+  uint8_t i = extentFind(index);
+  PfsExtent_t* e = i ? &extent_[i - 1] : 0;
+  if (e && index <= (e->index + e->count)
+    && (cluster - index) == (e->cluster - e->index)) {
+    // the run overlaps or continues the previous run
+    if ((index + count) > (e->index + e->count)) {
+      e->count = index + count - e->index;
+    }
+    i--;
+  } else if (e && index < (e->index + e->count)) {
+    // a chain can't differ from a run already known
+    return;
+  } else {
+    // a new run, also after the end of a run it does not continue
+    if (extentCount_ == EXTENT_CACHE_SIZE) {
+      // drop the last run, keeps the start of the file and the end of a walk
+      extentCount_--;
+      if (i > extentCount_) i = extentCount_;
+    }
+    memmove(&extent_[i + 1], &extent_[i],
+            (extentCount_ - i)*sizeof(PfsExtent_t));
+    e = &extent_[i];
+    e->index = index;
+    e->cluster = cluster;
+    e->count = count;
+    extentCount_++;
+  }
+  // absorb following runs that are now adjacent
+  while ((i + 1) < extentCount_ &&
+         extent_[i + 1].index <= (e->index + e->count) &&
+         (extent_[i + 1].cluster - extent_[i + 1].index) ==
+         (e->cluster - e->index)) {
+    uint32_t end = extent_[i + 1].index + extent_[i + 1].count;
+    if (end > (e->index + e->count)) e->count = end - e->index;
+    extentCount_--;
+    memmove(&extent_[i + 1], &extent_[i + 2],
+            (extentCount_ - i - 1)*sizeof(PfsExtent_t));
+  }
+  // a second run ends a contiguous file
+  if (extentCount_ > 1 && isContiguous()) {
+    flags_ &= ~F_CONTIGUOUS;
+    flags_ |= F_FILE_DIR_DIRTY;
+  }
+}
+
+// Return the number of extents that start at or before index.
+uint8_t SdBaseFile::extentFind(uint32_t index) {
+  uint8_t lo = 0;
+  uint8_t hi = extentCount_;
+  while (lo < hi) {
+    uint8_t mid = (lo + hi) >> 1;
+    if (extent_[mid].index <= index) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// Find cluster index of the chain.  The chain is only followed from the
+// end of the closest extent at or before index.
+bool SdBaseFile::clusterOf(uint32_t index, uint32_t* cluster) {
+  uint32_t n = 0;
+  uint32_t c = firstCluster_;
+  uint8_t i = extentFind(index);
+  if (i) {
+    PfsExtent_t* e = &extent_[i - 1];
+    if (index < (e->index + e->count)) {
+      *cluster = e->cluster + index - e->index;
+      return true;
+    }
+    n = e->index + e->count - 1;
+    c = e->cluster + e->count - 1;
+  } else if (c == 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  } else {
+    extentAdd(0, c);
+  }
+  while (n < index) {
+    if (!vol_->pfsGet(c, &c) || vol_->isEOC(c)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    extentAdd(++n, c);
+  }
+  *cluster = c;
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::openCachedEntry(uint8_t dirIndex, uint8_t oflag) {
+  // location of entry in cache
+  dir_t* p = &vol_->cacheAddress()->dir[dirIndex];
+
+  // write or truncate is an error for a directory or read-only file
+  if (p->attributes & (DIR_ATT_READ_ONLY | DIR_ATT_DIRECTORY)) {
+    if (oflag & O_WRITE) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  // remember location of directory entry on SD
+  dirBlock_ = vol_->cacheBlockNumber();
+  dirIndex_ = dirIndex;
+#if DIR_HASH_SIZE
+  // set by open() and openNext()
+  dirCluster_ = 0;
+#endif  // DIR_HASH_SIZE
+
+  // copy first cluster number for directory fields
+  firstCluster_ = p->firstCluster;
+
+  // make sure it is a normal file or subdirectory
+  if (DIR_IS_FILE(p)) {
+    fileSize_ = p->fileSize;
+    type_ = PFS_FILE_TYPE_NORMAL;
+  } else if (DIR_IS_SUBDIR(p)) {
+    if (!setDirSize(p->clusterCount)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    type_ = PFS_FILE_TYPE_SUBDIR;
+  } else {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // save open flags for read/write
+  flags_ = oflag & F_OFLAG;
+  syncBytes_ = 0;
+
+  // keep the directory entry cached for sync() of a file being written
+  if ((oflag & O_WRITE) && vol_->cachePin(dirBlock_)) flags_ |= F_DIR_PINNED;
+
+  // set to start of file
+  curCluster_ = 0;
+  curPosition_ = 0;
+  extentCount_ = 0;
+#if READ_AHEAD_BLOCKS
+  readEnd_ = 0;
+  readAheadPos_ = 0;
+#endif  // READ_AHEAD_BLOCKS
+
+  // whole allocation of a contiguous file is one extent, p is not valid
+  // after setDirSize() but is only used for a file
+  if (isFile() && (p->pfsFlags & DIR_PFS_CONTIGUOUS) && firstCluster_) {
+    extentAdd(0, firstCluster_, p->clusterCount);
+    flags_ |= F_CONTIGUOUS;
+  }
+  return true;
+
+ fail:
+  type_ = PFS_FILE_TYPE_CLOSED;
+  return false;
+}
+
+bool SdBaseFile::open(SdBaseFile* dirFile, const uint8_t dname[11], uint8_t oflag) {
+  cache_t* pc;
+  uint8_t i;
+  uint32_t entry = 0;
+
+  bool emptyFound = false;
+  bool fileFound = false;  
+  dir_t* p;
+  
+  if(dirFile->isFile()) goto fail;
+
+  vol_ = dirFile->vol_;
+
+#if DIR_HASH_SIZE
+  if (dirFile->firstCluster_ != vol_->dirHashCluster_) {
+    if (!dirFile->dirHashBuild()) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  if (vol_->dirHashed(dirFile->firstCluster_)) {
+    // only entries with the same hash can match
+    for (uint16_t h = SdVolume::dirHashSlot(dname); vol_->dirHash_[h];
+         h = (h + 1) & (DIR_HASH_SIZE - 1)) {
+      if (vol_->dirHash_[h] == SdVolume::DIR_HASH_REMOVED) continue;
+      entry = vol_->dirHash_[h] - 1;
+      if (!dirFile->seekSet(entry << 5)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      p = dirFile->readDirCache();
+      if (!p) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      if (memcmp(p->name, dname, 11) == 0) {
+        i = entry & 0XF;
+        fileFound = true;
+        break;
+      }
+    }
+    if (!fileFound) {
+      if (!(oflag & O_CREAT)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      // name is not used, search for a free entry
+      if (!dirFile->seekSet(vol_->dirHashFree_ << 5)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    }
+  } else  // NOLINT
+#endif  // DIR_HASH_SIZE
+  //porque hay que buscar secuencialmente
+  dirFile->rewind();
+
+  while (!fileFound && dirFile->curPosition_ < dirFile->fileSize_) {
+    i = (dirFile->curPosition_ >> 5) & 0XF;
+    p = dirFile->readDirCache();
+    if (!p) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if(p->name[0] == DIR_NAME_FREE || p->name[0] == DIR_NAME_DELETED){
+      if (!emptyFound) {
+        emptyFound = true;
+        dirBlock_ = vol_->cacheBlockNumber();
+        dirIndex_ = i;        
+        entry = (dirFile->curPosition_ >> 5) - 1;
+      }
+      // done if no entries follow
+      if (p->name[0] == DIR_NAME_FREE) break;
+    }else{
+      if(memcmp(p->name, dname, 11)==0){
+        fileFound = true;
+        entry = (dirFile->curPosition_ >> 5) - 1;
+        break;
+      }
+    }
+  }
+  
+  if(!fileFound){
+    if(!(oflag & O_CREAT)){
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    #if !ENABLED_READ_ONLY
+    if(emptyFound){
+      p = cacheDirEntry(SdVolume::CACHE_FOR_LOG);
+      if (!p) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      i = dirIndex_;
+    }else{
+      entry = dirFile->fileSize_ >> 5;
+      pc = dirFile->addDirCluster();
+      if (!pc) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      i = 0;
+      p = pc->dir;
+    }
+    memset(p, 0, sizeof(dir_t));
+    memcpy(p->name, dname, 11);
+#if DIR_HASH_SIZE
+    if (vol_->dirHashed(dirFile->firstCluster_)) {
+      vol_->dirHashInsert(dname, entry);
+      vol_->dirHashFree_ = entry + 1;
+    }
+#endif  // DIR_HASH_SIZE
+    #else  // ENABLED_READ_ONLY
+    DBG_FAIL_MACRO;
+    goto fail;
+    #endif  // ENABLED_READ_ONLY
+  }
+  if (!openCachedEntry(i, oflag)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if DIR_HASH_SIZE
+  // remove() updates the hash of this directory
+  dirCluster_ = dirFile->firstCluster_;
+  dirEntry_ = entry;
+#else  // DIR_HASH_SIZE
+  (void)entry;
+#endif  // DIR_HASH_SIZE
+  // record the size of a subdirectory that was extended
+  if ((dirFile->flags_ & F_FILE_DIR_DIRTY) && !dirFile->sync()) {
+    // don't leave this file open with its entry pinned
+    close();
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::openRoot(SdVolume* vol) {
+  if (isOpen()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  vol_ = vol;
+  type_ = PFS_FILE_TYPE_ROOT32;
+  firstCluster_ = vol->rootDirStart();
+  if (!setDirSize(vol->rootClusterCount_)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  vol->rootClusterCount_ = clusterIndex(fileSize_);
+  flags_ = O_RDONLY;
+
+  dirBlock_ = firstCluster_;
+  dirIndex_ = 0;
+
+  curCluster_ = 0;
+  curPosition_ = 0;  
+  extentCount_ = 0;
+#if READ_AHEAD_BLOCKS
+  readEnd_ = 0;
+  readAheadPos_ = 0;
+#endif  // READ_AHEAD_BLOCKS
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::openNext(SdBaseFile* dirFile, uint8_t oflag){
+  if (!dirFile || isOpen()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  vol_ = dirFile->vol_;
+
+  dir_t* p;
+  uint8_t i;
+
+  do{
+    i = (dirFile->curPosition_ >> 5) & 0XF;
+    if(!(p = dirFile->readDirCache())){
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (p->name[0] == DIR_NAME_FREE) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (p->name[0] == DIR_NAME_DELETED || p->name[0] == '.') {
+      continue;
+    }
+    if (DIR_IS_FILE_OR_SUBDIR(p)) {
+      if (!openCachedEntry(i, oflag)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+#if DIR_HASH_SIZE
+      dirCluster_ = dirFile->firstCluster_;
+      dirEntry_ = (dirFile->curPosition_ >> 5) - 1;
+#endif  // DIR_HASH_SIZE
+      return true;
+    }
+  }while(true);
+  
+ fail:
+  return false;
+}
+
+bool SdBaseFile::close() {
+  bool res = sync();
+  if (flags_ & F_DIR_PINNED) vol_->cacheUnpin(dirBlock_);
+  type_ = PFS_FILE_TYPE_CLOSED;
+  return res;
+}
+
+#if !ENABLED_READ_ONLY
+int SdBaseFile::write(const void* buf, size_t nbyte) {
+  // convert void* to uint8_t*  -  must be before goto statements
+  const uint8_t* src = reinterpret_cast<const uint8_t*>(buf);
+  cache_t* pc;
+  uint8_t cacheOption;
+  // number of bytes left to write  -  must be before goto statements
+  size_t nToWrite = nbyte;
+  size_t n;
+  // error if not a normal file or is read-only
+  if (!isFile() || !(flags_ & O_WRITE)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+
+  while (nToWrite) {
+    uint8_t blockOfCluster = vol_->blockOfCluster(curPosition_);
+    uint16_t blockOffset = curPosition_ & 0X1FF;
+    if (blockOfCluster == 0 && blockOffset == 0) {
+      // start of new cluster
+      if (isContiguous() && curCluster_ != 0 &&
+          clusterIndex(curPosition_) < extent_[0].count) {
+        // next cluster of a contiguous file
+        curCluster_++;
+      } else if (curCluster_ != 0) {
+        uint32_t next;
+        if (!vol_->pfsGet(curCluster_, &next)) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+        if (vol_->isEOC(next)) {
+          // add cluster if at end of chain
+          if (!addCluster()) {
+            DBG_FAIL_MACRO;
+            goto fail;
+          }
+        } else {
+          curCluster_ = next;
+        }
+      } else {
+        if (firstCluster_ == 0) {
+          // allocate first cluster of file
+          if (!addCluster()) {
+            DBG_FAIL_MACRO;
+            goto fail;
+          }
+        } else {
+          curCluster_ = firstCluster_;
+        }
+      }
+      extentAdd(clusterIndex(curPosition_), curCluster_);
+    }
+    // block for data write
+    uint32_t block = vol_->clusterStartBlock(curCluster_) + blockOfCluster;
+
+    if (blockOffset != 0 || nToWrite < 512) {
+      // partial block - must use cache
+      // max space in block
+      n = 512 - blockOffset;
+      // lesser of space and amount to write
+      if (n > nToWrite) n = nToWrite;
+
+      if (blockOffset == 0 && curPosition_ >= fileSize_) {
+        // start of new block don't need to read into cache
+        cacheOption = SdVolume::CACHE_RESERVE_FOR_WRITE;
+      } else {
+        // rewrite part of block
+        cacheOption = SdVolume::CACHE_FOR_WRITE;
+        }
+        pc = vol_->cacheFetch(block, cacheOption);
+        if (!pc) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+      uint8_t* dst = pc->data + blockOffset;
+      memcpy(dst, src, n);
+      if (512 == (n + blockOffset)) {
+        if (!vol_->cacheWriteData()) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+      }
+    } else if (!USE_MULTI_BLOCK_SD_IO || nToWrite < 1024) {
+      // use single block write command
+      n = 512;
+      // cached copy will be replaced by the data written
+      vol_->cacheInvalidate(block);
+      if (!vol_->writeBlock(block, src)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    } else {
+      // use multiple block write command with pre-erase
+      uint32_t nb;
+      uint32_t lastCluster;
+      if (!contiguousRun(blockOfCluster, nToWrite >> 9, true,
+                         &nb, &lastCluster)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      n = 512*nb;
+      // cached blocks will be replaced by the data written
+      vol_->cacheInvalidate(block, nb);
+      if (!vol_->cardIdle() || !vol_->sdCard()->writeStart(block, nb)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      for (uint32_t b = 0; b < nb; b++) {
+        if (!vol_->sdCard()->writeData(src + 512*b)) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+      }
+      if (!vol_->sdCard()->writeStop()) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      extentAdd(clusterIndex(curPosition_), curCluster_,
+                lastCluster - curCluster_ + 1);
+      curCluster_ = lastCluster;
+    }
+    curPosition_ += n;
+    src += n;
+    nToWrite -= n;
+  }
+  if (curPosition_ > fileSize_) {
+    // update fileSize and insure sync will update dir entry
+    fileSize_ = curPosition_;
+    flags_ |= F_FILE_DIR_DIRTY;
+  }
+  if (syncBytes_ == 0) syncMillis_ = millis();
+  syncBytes_ += nbyte;
+  if ((flags_ & O_SYNC)
+    || (WRITE_SYNC_BYTES && syncBytes_ >= WRITE_SYNC_BYTES)
+    || (WRITE_SYNC_MILLIS
+      && (uint16_t)((uint16_t)millis() - syncMillis_) >= WRITE_SYNC_MILLIS)) {
+    if (!sync()) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  return nbyte;
+
+ fail:
+  return -1;
+}
+
+bool SdBaseFile::rmdir() {
+  // must be open subdirectory
+  if (!isSubDir()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  rewind();
+
+  // make sure directory is empty
+  while (curPosition_ < fileSize_) {
+    dir_t* p = readDirCache();
+    if (!p) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // done if past last used entry
+    if (p->name[0] == DIR_NAME_FREE) break;
+    // skip empty slot, '.' or '..'
+    if (p->name[0] == DIR_NAME_DELETED || p->name[0] == '.') continue;
+    // error not empty
+    if (DIR_IS_FILE_OR_SUBDIR(p)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  // convert empty directory to normal file for remove
+  type_ = PFS_FILE_TYPE_NORMAL;
+  flags_ |= O_WRITE;
+  return remove();
+
+ fail:
+  return false;
+}
+
+cache_t* SdBaseFile::addDirCluster() {
+  uint32_t block;
+  cache_t* pc;
+  if (!addCluster()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  block = vol_->clusterStartBlock(curCluster_);
+  pc = vol_->cacheFetch(block, SdVolume::CACHE_RESERVE_FOR_WRITE);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  memset(pc, 0, 512);
+  // zero rest of clusters
+  for (uint8_t i = 1; i < vol_->blocksPerCluster_; i++) {
+    if (!vol_->writeBlock(block + i, pc->data)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  extentAdd(clusterIndex(fileSize_), curCluster_);
+  // Increase directory file size by cluster size
+  fileSize_ += 512UL*vol_->blocksPerCluster_;
+  // the root size is kept by the volume, a subdirectory size in its entry
+  if (isRoot()) {
+    vol_->rootClusterCount_ = clusterIndex(fileSize_);
+  } else {
+    flags_ |= F_FILE_DIR_DIRTY;
+  }
+  return pc;
+
+ fail:
+  return 0;
+}
+
+bool SdBaseFile::createContiguous(SdBaseFile* dirFile,
+                                  const char* path, uint32_t size) {
+  if (size == 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!open(dirFile, path, O_CREAT | O_RDWR)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // fails if the file already has clusters
+  if (!preAllocate(size)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  fileSize_ = size;
+  flags_ |= F_FILE_DIR_DIRTY;
+  return sync();
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::preAllocate(uint32_t size) {
+  uint32_t count;
+  // must be an empty file open for write
+  if (!isFile() || !(flags_ & O_WRITE) || firstCluster_ != 0 || size == 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  count = clusterIndex(size - 1) + 1;
+  if (!vol_->allocContiguous(count, &firstCluster_)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  extentCount_ = 0;
+  extentAdd(0, firstCluster_, count);
+  flags_ |= F_CONTIGUOUS | F_FILE_DIR_DIRTY;
+  return sync();
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::writeStreamStart() {
+  uint32_t bgnBlock;
+  uint32_t endBlock;
+  uint32_t block;
+  if (!(flags_ & O_WRITE) || (flags_ & F_STREAM) || (curPosition_ & 0X1FF)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!contiguousRange(&bgnBlock, &endBlock)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  block = bgnBlock + (curPosition_ >> 9);
+  if (block > endBlock) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // cached copies of the range are replaced by the stream
+  if (!vol_->cacheSync()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  vol_->cacheInvalidate(block, endBlock - block + 1);
+  if (!vol_->cardIdle() ||
+      !vol_->sdCard()->writeStart(block, endBlock - block + 1)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  flags_ |= F_STREAM;
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::writeStreamData(const uint8_t* src) {
+  // stay inside the allocation
+  if (!(flags_ & F_STREAM) || (curPosition_ >> 9) >=
+      ((uint32_t)extent_[0].count << vol_->clusterSizeShift())) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!vol_->sdCard()->writeData(src)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  curPosition_ += 512;
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::writeStreamStop() {
+  if (!(flags_ & F_STREAM)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  flags_ &= ~F_STREAM;
+  if (!vol_->sdCard()->writeStop()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (curPosition_ > fileSize_) {
+    fileSize_ = curPosition_;
+    flags_ |= F_FILE_DIR_DIRTY;
+  }
+  if (!seekSet(curPosition_)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  return sync();
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::remove(SdBaseFile* dirFile, const char* path) {
+  SdBaseFile file;
+  if (!file.open(dirFile, path, O_WRITE)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  return file.remove();
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::remove() {
+  dir_t* d;
+  // free any clusters - will fail if read-only or directory
+  if (!truncate()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // cache directory entry
+  d = cacheDirEntry(SdVolume::CACHE_FOR_LOG);
+  if (!d) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if DIR_HASH_SIZE
+  // a create in the directory can reuse the entry
+  if (vol_->dirHashed(dirCluster_)) vol_->dirHashRemove(d->name, dirEntry_);
+#endif  // DIR_HASH_SIZE
+  // mark entry deleted
+  d->name[0] = DIR_NAME_DELETED;
+
+  // set this file closed
+  if (flags_ & F_DIR_PINNED) vol_->cacheUnpin(dirBlock_);
+  type_ = PFS_FILE_TYPE_CLOSED;
+
+  // write entry to SD
+  return vol_->sync();
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::mkdir(SdBaseFile* dir, const char dname[11]){
+  if(!dir->isRoot()){
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  dir_t* p;
+  // an existing file would become the directory
+  if (dir->exists(dname)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!open(dir, dname, O_CREAT | O_RDWR)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  type_ = PFS_FILE_TYPE_SUBDIR;
+  flags_ = O_READ | (flags_ & F_DIR_PINNED);
+
+  if (!addDirCluster()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if((p = cacheDirEntry(SdVolume::CACHE_FOR_LOG)) == 0){
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  p->attributes = DIR_ATT_DIRECTORY;
+  // write first cluster and size of the directory
+  return sync();
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::truncate() {
+  uint32_t newPos;
+  uint32_t cluster;
+  uint32_t count;
+  // error if not a normal file or read-only
+  if (!isFile() || !(flags_ & O_WRITE)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+
+  // fileSize and length are zero - nothing to do
+  if (fileSize_ == 0) return true;
+
+  // remember position for seek after truncation
+  newPos = 0;
+
+#if DIR_HASH_SIZE
+  // the clusters of a removed directory may be reused for another
+  if (firstCluster_ == vol_->dirHashCluster_) vol_->dirHashClear(0);
+#endif  // DIR_HASH_SIZE
+  // the allocation of a contiguous file is one run
+  cluster = firstCluster_;
+  count = isContiguous() ? extent_[0].count : 0;
+  firstCluster_ = 0;
+  extentCount_ = 0;
+  flags_ &= ~F_CONTIGUOUS;
+  
+  fileSize_ = 0;
+
+  // the entry is cleared before the chain is freed so a power loss while
+  // a long chain is freed only loses clusters
+  flags_ |= F_FILE_DIR_DIRTY;
+  if (!syncDirEntry() || !vol_->freeChain(cluster, count)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!sync()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // set file to correct position
+  return seekSet(0);
+
+ fail:
+  return false;
+}
+#endif
+
+bool SdBaseFile::seekSet(uint32_t pos) {
+  if (!isOpen() || pos > fileSize_) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (type_ == PFS_FILE_TYPE_ROOT_FIXED) {
+    curPosition_ = pos;
+    goto done;
+  }
+  if (pos == 0) {
+    // read and write start at firstCluster_
+    curCluster_ = 0;
+  } else if (!clusterOf(clusterIndex(pos - 1), &curCluster_)) {
+    // curCluster_ holds the byte before pos, as after a read or write
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  curPosition_ = pos;
+
+ done:
+  return true;
+
+ fail:
+  return false;
+}
+
+int SdBaseFile::peek() {
+  PfsPos_t pos;
+  getpos(&pos);
+  int c = read();
+  if (c >= 0) setpos(&pos);
+  return c;
+}
+
+// Set the size of a directory with count clusters.  If count is zero
+// the size is not known and the cluster chain is followed.
+bool SdBaseFile::setDirSize(uint32_t count) {
+  uint32_t cluster = firstCluster_;
+  if (count == 0) {
+    do {
+      if (!vol_->pfsGet(cluster, &cluster)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      // a loop in the chain
+      if (++count > vol_->clusterCount()) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    } while (!vol_->isEOC(cluster));
+  }
+  fileSize_ = count << (9 + vol_->clusterSizeShift());
+  return true;
+
+ fail:
+  return false;
+}
+
+void SdBaseFile::dirName(const dir_t& dir, char* name) {
+  uint8_t j = 0;
+  for (uint8_t i = 0; i < 11; i++) {
+    if (dir.name[i] == ' ')continue;
+    if (i == 8) name[j++] = '.';
+    name[j++] = dir.name[i];
+  }
+  name[j] = 0;
+}
+
+bool SdBaseFile::getFilename(char* name) {
+  dir_t* p;
+  if (!isOpen()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (isRoot()) {
+    name[0] = '/';
+    name[1] = '\0';
+    return true;
+  }
+  // cache entry
+  p = cacheDirEntry(SdVolume::CACHE_FOR_READ);
+  if (!p) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // format name
+  dirName(*p, name);
+  return true;
+
+ fail:
+  return false;
+}
+
+// Check that the file is one run of clusters and return its blocks.
+bool SdBaseFile::contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock) {
+  if (!isFile() || firstCluster_ == 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!isContiguous()) {
+    uint32_t c = firstCluster_;
+    uint32_t count = 1;
+    while (true) {
+      uint32_t next;
+      if (!vol_->pfsGet(c, &next)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      if (vol_->isEOC(next)) break;
+      if (next != (c + 1)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      c = next;
+      count++;
+    }
+    // remember the result
+    extentCount_ = 0;
+    extentAdd(0, firstCluster_, count);
+    flags_ |= F_CONTIGUOUS;
+    if (flags_ & O_WRITE) flags_ |= F_FILE_DIR_DIRTY;
+  }
+  *bgnBlock = vol_->clusterStartBlock(firstCluster_);
+  *endBlock = *bgnBlock + (extent_[0].count << vol_->clusterSizeShift()) - 1;
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::readStreamStart() {
+  uint32_t bgnBlock;
+  uint32_t endBlock;
+  if (!(flags_ & O_READ) || (flags_ & F_STREAM) || (curPosition_ & 0X1FF)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!contiguousRange(&bgnBlock, &endBlock)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // the card must hold data still in the cache
+  if (!vol_->cacheSync()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!vol_->cardIdle() ||
+      !vol_->sdCard()->readStart(bgnBlock + (curPosition_ >> 9))) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  flags_ |= F_STREAM;
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::readStreamData(uint8_t* dst) {
+  // a partial last block is returned whole
+  if (!(flags_ & F_STREAM) || curPosition_ >= fileSize_) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!vol_->sdCard()->readData(dst)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  curPosition_ += 512;
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdBaseFile::readStreamStop() {
+  if (!(flags_ & F_STREAM)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  flags_ &= ~F_STREAM;
+  if (!vol_->sdCard()->readStop()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  return seekSet(curPosition_ < fileSize_ ? curPosition_ : fileSize_);
+
+ fail:
+  return false;
+}
+
+#if READ_AHEAD_BLOCKS
+// Queue the blocks after the current block in the volume read-ahead ring.
+// Blocks already queued by an earlier call are skipped.
+bool SdBaseFile::readAhead() {
+  uint32_t pos = (curPosition_ | 0X1FF) + 1;
+  uint32_t end = pos + 512UL*READ_AHEAD_BLOCKS;
+  if (readAheadPos_ > pos && readAheadPos_ <= end) pos = readAheadPos_;
+  if (end > fileSize_) end = fileSize_;
+  for (; pos < end; pos += 512) {
+    uint32_t cluster;
+    if (!clusterOf(clusterIndex(pos), &cluster)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    uint32_t block = vol_->clusterStartBlock(cluster);
+    if (!vol_->readAheadAdd(block + vol_->blockOfCluster(pos))) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  readAheadPos_ = pos;
+  return true;
+
+ fail:
+  return false;
+}
+#endif  // READ_AHEAD_BLOCKS
+
+int16_t SdBaseFile::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+int SdBaseFile::read(void* buf, size_t nbyte) {
+  uint8_t blockOfCluster;
+  uint8_t* dst = reinterpret_cast<uint8_t*>(buf);
+  uint16_t offset;
+  size_t toRead;
+  uint32_t block;  // raw device block number
+  cache_t* pc;
+#if READ_AHEAD_BLOCKS
+  // read-ahead only follows reads that continue the last read
+  bool sequential = curPosition_ == readEnd_;
+#endif  // READ_AHEAD_BLOCKS
+
+  // error if not open or write only
+  if (!isOpen() || !(flags_ & O_READ)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // max bytes left in file
+  if (nbyte >= (fileSize_ - curPosition_)) {
+    nbyte = fileSize_ - curPosition_;
+  }
+  // amount left to read
+  toRead = nbyte;
+  while (toRead > 0) {
+    size_t n;
+    offset = curPosition_ & 0X1FF;  // offset in block
+    blockOfCluster = vol_->blockOfCluster(curPosition_);
+
+    if (offset == 0 && blockOfCluster == 0) {
+      // start of new cluster
+      if (curPosition_ == 0) {
+        // use first cluster in file
+        curCluster_ = firstCluster_;
+      } else if (isContiguous() &&
+                 clusterIndex(curPosition_) < extent_[0].count) {
+        // next cluster of a contiguous file
+        curCluster_++;
+      } else {
+        // get next cluster from FAT
+        if (!vol_->pfsGet(curCluster_, &curCluster_)) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+      }
+      extentAdd(clusterIndex(curPosition_), curCluster_);
+    }
+    block = vol_->clusterStartBlock(curCluster_) + blockOfCluster;
+    
+    if (offset != 0 || toRead < 512 || vol_->cacheHas(block)) {
+      // amount to be read from current block
+      n = 512 - offset;
+      if (n > toRead) n = toRead;
+      // read block to cache and copy data to caller
+      pc = vol_->cacheFetch(block, SdVolume::CACHE_FOR_READ);
+      if (!pc) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      uint8_t* src = pc->data + offset;
+      memcpy(dst, src, n);
+#if READ_AHEAD_BLOCKS
+      if (sequential && offset == 0 && isFile()) {
+        if (!readAhead()) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+      }
+#endif  // READ_AHEAD_BLOCKS
+    } else if (!USE_MULTI_BLOCK_SD_IO || toRead < 1024) {
+      // read single block
+      n = 512;
+      if (!vol_->readBlock(block, dst)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    } else {
+      uint32_t nb;
+      uint32_t lastCluster;
+      if (!contiguousRun(blockOfCluster, toRead >> 9, false,
+                         &nb, &lastCluster)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      n = 512*nb;
+      if (vol_->cacheHas(block, nb)) {
+        // flush cache if a block is in the cache
+        if (!vol_->cacheSync()) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+      }
+      if (!vol_->cardIdle() || !vol_->sdCard()->readStart(block)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      for (uint32_t b = 0; b < nb; b++) {
+        if (!vol_->sdCard()->readData(dst + b*512)) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+      }
+      if (!vol_->sdCard()->readStop()) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      extentAdd(clusterIndex(curPosition_), curCluster_,
+                lastCluster - curCluster_ + 1);
+      curCluster_ = lastCluster;
+    }
+    dst += n;
+    curPosition_ += n;
+    toRead -= n;
+  }
+#if READ_AHEAD_BLOCKS
+  readEnd_ = curPosition_;
+#endif  // READ_AHEAD_BLOCKS
+  return nbyte;
+
+ fail:
+  return -1;
+}
+
@@ -1,150 +1,226 @@
-/* Arduino PFS Library
- * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
- *
- * This file is part of the Arduino PFS Library
- *
- * This Library is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This Library is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with the Arduino PFS Library.  If not, see
- * <http://www.gnu.org/licenses/>.
- */
-/*
- *Creditos: https://github.com/frasermac/sdfatlib
- */
-#ifndef SdBaseFile_h
-#define SdBaseFile_h
-
-#include <Arduino.h>
-#include <SdPfsConfig.h>
-#include <SdVolume.h>
-
-#ifdef __AVR__
-#include <avr/pgmspace.h>
-#else
-#ifndef PGM_P
-#define PGM_P const char*
-#endif  // PGM_P
-#ifndef PSTR
-#define PSTR(x) (x)
-#endif  // PSTR
-#ifndef pgm_read_byte
-#define pgm_read_byte(addr) (*(const unsigned char*)(addr))
-#endif  // pgm_read_byte
-#ifndef pgm_read_word
-#define pgm_read_word(addr) (*(const uint16_t*)(addr))
-#endif  // pgm_read_word
-#ifndef PROGMEM
-#define PROGMEM const
-#endif  // PROGMEM
-#endif  // __AVR__
-
-struct PfsPos_t {
-  uint32_t position;
-  uint32_t cluster;
-  PfsPos_t() : position(0), cluster(0) {}
-};
-
-class SdBaseFile {
- public:
-  SdBaseFile() : type_(PFS_FILE_TYPE_CLOSED) {}
-  SdBaseFile(const char* path, uint8_t oflag); //ya
-#if DESTRUCTOR_CLOSES_FILE
-  ~SdBaseFile() {if(isOpen()) close();} //ya
-#endif  // DESTRUCTOR_CLOSES_FILE
-
-  void getpos(PfsPos_t* pos); //ya
-  void setpos(PfsPos_t* pos); //ya
-
-  uint32_t available() {return fileSize() - curPosition();}  //ya
-
-  uint32_t curCluster() const {return curCluster_;} //ya
-  uint32_t curPosition() const {return curPosition_;} //ya
-
-  static SdBaseFile* cwd() {return SdBaseFile::cwd_;}   //ya
-
-  uint32_t fileSize() const {return fileSize_;} //ya
-  bool getFilename(char* name); //ya
-  bool exists(const char* name);
-
-  bool isDir() const {return type_ >= PFS_FILE_TYPE_MIN_DIR;} //ya
-  bool isFile() const {return type_ == PFS_FILE_TYPE_NORMAL;} //ya
-  bool isOpen() const {return type_ != PFS_FILE_TYPE_CLOSED;} //ya
-  bool isSubDir() const {return type_ == PFS_FILE_TYPE_SUBDIR;} //ya
-  bool isRoot() const {return type_ == PFS_FILE_TYPE_ROOT32;} //ya
-  
-  bool open(const char* path, uint8_t oflag = O_READ); //ya
-  bool open(SdBaseFile* dirFile, const char* path, uint8_t oflag); //ya
-  bool open(SdBaseFile* dirFile, const uint8_t dname[11], uint8_t oflag); //ya
-  bool openRoot(SdVolume* vol); //ya
-  bool openNext(SdBaseFile* dirFile, uint8_t oflag); //ya
-  bool close(); //ya
-
-  #if !ENABLED_READ_ONLY
-  bool mkdir(SdBaseFile* dir, const char dname[11]); //ya
-  cache_t* addDirCluster(); //ya
-  static bool remove(SdBaseFile* dirFile, const char* path); //ya
-  bool remove(); //ya
-  bool truncate(); //ya
-  bool rmdir(); //ya
-  int write(const void* buf, size_t nbyte);
-  #endif  
-
-  static void dirName(const dir_t& dir, char* name);
-
-  int16_t read(); //ya
-  int read(void* buf, size_t nbyte); //ya
-  int peek(); //ya  
-  
-  bool seek(uint32_t pos, uint8_t option); //ya
-  void rewind() {seekSet(0);} //ya
-  
-  bool sync(); //ya
-
-private:
-  friend class SdPfs;       // allow SdPfs to set cwd_  
-
-  SdVolume* vol_;           // volume where file is located
-  uint32_t  curCluster_;    // cluster for current file position
-  uint32_t  curPosition_;   // current file position in bytes from beginning}
-  uint32_t  fileSize_;      // file size in bytes  
-  uint32_t  dirBlock_;      // block for this files directory entry
-  uint32_t  firstCluster_;  // first cluster of file
-  
-  static SdBaseFile* cwd_;  // global pointer to cwd dir
-
-  bool seekSet(uint32_t pos); //ya
-  bool seekEnd(int32_t offset = 0) {return seekSet(fileSize_ + offset);} //ya
-  bool seekCur(int32_t offset) {return seekSet(curPosition_ + offset); } //ya
-
-  /** Cache related*/
-  bool openCachedEntry(uint8_t cacheIndex, uint8_t oflags); //ya
-  dir_t* readDirCache(); //ya
-  dir_t* cacheDirEntry(uint8_t action); //ya
-  bool addCluster(); //ya
-
-
-  static bool make83Name(const char* str, char* name, const char** ptr); //ya
-  bool setDirSize(); //ya
-
-  // bits defined in flags_
-  // should be 0X0F
-  static uint8_t const F_OFLAG = O_ACCMODE;
-  // sync of directory entry required
-  static uint8_t const F_FILE_DIR_DIRTY = 0X80;
-
-  uint8_t   flags_;         // See above for definition of flags_ bits
-  uint8_t   fstate_;        // error and eof indicator
-  uint8_t   type_;          // type of file see above for values
-  uint8_t   dirIndex_;      // index of directory entry in dirBlock
-};
-
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ *Creditos: https://github.com/frasermac/sdfatlib
+ */
+#ifndef SdBaseFile_h
+#define SdBaseFile_h
+
+#include <SdPfsConfig.h>
+#if !USE_HOST_SD_CARD
+#include <Arduino.h>
+#endif  // USE_HOST_SD_CARD
+#include <SdVolume.h>
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#ifndef PGM_P
+#define PGM_P const char*
+#endif  // PGM_P
+#ifndef PSTR
+#define PSTR(x) (x)
+#endif  // PSTR
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const unsigned char*)(addr))
+#endif  // pgm_read_byte
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#endif  // pgm_read_word
+#ifndef PROGMEM
+#define PROGMEM const
+#endif  // PROGMEM
+#endif  // __AVR__
+
+struct PfsPos_t {
+  uint32_t position;
+  uint32_t cluster;
+  PfsPos_t() : position(0), cluster(0) {}
+};
+
+// directory entry returned by readdir()
+struct PfsDirent_t {
+  char     name[13];      // 8.3 name with dot, zero terminated
+  uint8_t  attributes;    // DIR_ATT_ bits
+  uint32_t fileSize;      // size of a file in bytes, for a subdirectory
+                          // the size of its clusters or zero if the entry
+                          // has no cluster count
+  uint32_t firstCluster;  // first cluster, zero for an empty file
+};
+
+// run of adjacent clusters in a file's chain
+struct PfsExtent_t {
+  uint32_t index;    // position of first cluster in the chain
+  uint32_t cluster;  // first cluster on the volume
+  uint32_t count;    // number of clusters in the run
+};
+
+class SdBaseFile {
+ public:
+  SdBaseFile() : type_(PFS_FILE_TYPE_CLOSED) {}
+  SdBaseFile(const char* path, uint8_t oflag); //ya
+#if DESTRUCTOR_CLOSES_FILE
+  ~SdBaseFile() {if(isOpen()) close();} //ya
+#endif  // DESTRUCTOR_CLOSES_FILE
+
+  void getpos(PfsPos_t* pos); //ya
+  void setpos(PfsPos_t* pos); //ya
+
+  uint32_t available() {return fileSize() - curPosition();}  //ya
+
+  uint32_t curCluster() const {return curCluster_;} //ya
+  uint32_t curPosition() const {return curPosition_;} //ya
+
+  static SdBaseFile* cwd() {return SdBaseFile::cwd_;}   //ya
+
+  uint32_t fileSize() const {return fileSize_;} //ya
+  bool getFilename(char* name); //ya
+  bool exists(const char* name);
+  int readdir(PfsDirent_t* ent, uint16_t count);
+#if USING_APP
+  void ls(Print* pr, uint8_t flags = 0, uint8_t indent = 0);
+#endif  // USING_APP
+
+  bool isContiguous() const {return flags_ & F_CONTIGUOUS;}
+  bool isDir() const {return type_ >= PFS_FILE_TYPE_MIN_DIR;} //ya
+  bool isFile() const {return type_ == PFS_FILE_TYPE_NORMAL;} //ya
+  bool isOpen() const {return type_ != PFS_FILE_TYPE_CLOSED;} //ya
+  bool isSubDir() const {return type_ == PFS_FILE_TYPE_SUBDIR;} //ya
+  bool isRoot() const {return type_ == PFS_FILE_TYPE_ROOT32;} //ya
+  
+  bool open(const char* path, uint8_t oflag = O_READ); //ya
+  bool open(SdBaseFile* dirFile, const char* path, uint8_t oflag); //ya
+  bool open(SdBaseFile* dirFile, const uint8_t dname[11], uint8_t oflag); //ya
+  bool openRoot(SdVolume* vol); //ya
+  bool openNext(SdBaseFile* dirFile, uint8_t oflag); //ya
+  bool close(); //ya
+
+  #if !ENABLED_READ_ONLY
+  bool createContiguous(SdBaseFile* dirFile, const char* path, uint32_t size);
+  bool preAllocate(uint32_t size);
+  bool writeStreamStart();
+  bool writeStreamData(const uint8_t* src);
+  bool writeStreamStop();
+  bool mkdir(SdBaseFile* dir, const char dname[11]); //ya
+  cache_t* addDirCluster(); //ya
+  static bool remove(SdBaseFile* dirFile, const char* path); //ya
+  bool remove(); //ya
+  bool truncate(); //ya
+  bool rmdir(); //ya
+  int write(const void* buf, size_t nbyte);
+  #endif  
+
+  static void dirName(const dir_t& dir, char* name);
+
+  int16_t read(); //ya
+  int read(void* buf, size_t nbyte); //ya
+  int peek(); //ya  
+
+  /** Raw block streaming of a contiguous file.
+   *
+   * Start at the current position, which must be a multiple of 512, and
+   * move one block per Data call with no cache or PFS table access.  No
+   * other card I/O is allowed between Start and Stop.  Stop updates the
+   * file position and size.
+   */
+  bool contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock);
+  bool readStreamStart();
+  bool readStreamData(uint8_t* dst);
+  bool readStreamStop();
+  
+  bool seek(uint32_t pos, uint8_t option); //ya
+  void rewind() {seekSet(0);} //ya
+  
+  bool sync(); //ya
+
+private:
+  friend class SdPfs;       // allow SdPfs to set cwd_  
+
+  SdVolume* vol_;           // volume where file is located
+  uint32_t  curCluster_;    // cluster for current file position
+  uint32_t  curPosition_;   // current file position in bytes from beginning}
+  uint32_t  fileSize_;      // file size in bytes  
+  uint32_t  dirBlock_;      // block for this files directory entry
+  uint32_t  firstCluster_;  // first cluster of file
+  uint32_t  syncBytes_;     // bytes written since last sync
+  uint16_t  syncMillis_;    // time of first write since last sync
+  PfsExtent_t extent_[EXTENT_CACHE_SIZE];  // known runs sorted by index
+  uint8_t   extentCount_;   // number of valid entries in extent_
+#if DIR_HASH_SIZE
+  uint32_t  dirCluster_;    // first cluster of the directory, 0 if unknown
+  uint32_t  dirEntry_;      // entry number in the directory
+#endif  // DIR_HASH_SIZE
+#if READ_AHEAD_BLOCKS
+  uint32_t  readEnd_;       // position after the last read
+  uint32_t  readAheadPos_;  // position of the next block to queue
+#endif  // READ_AHEAD_BLOCKS
+  
+  static SdBaseFile* cwd_;  // global pointer to cwd dir
+
+  bool seekSet(uint32_t pos); //ya
+  bool seekEnd(int32_t offset = 0) {return seekSet(fileSize_ + offset);} //ya
+  bool seekCur(int32_t offset) {return seekSet(curPosition_ + offset); } //ya
+
+  /** Cache related*/
+  bool openCachedEntry(uint8_t cacheIndex, uint8_t oflags); //ya
+  dir_t* readDirCache(); //ya
+  dir_t* cacheDirEntry(uint8_t action); //ya
+  bool syncDirEntry();
+#if DIR_HASH_SIZE
+  bool dirHashBuild();
+#endif  // DIR_HASH_SIZE
+  bool addCluster(); //ya
+  bool contiguousRun(uint8_t blockOfCluster, uint32_t maxBlocks, bool alloc,
+                     uint32_t* count, uint32_t* lastCluster);
+
+  /** Extent related*/
+  void extentAdd(uint32_t index, uint32_t cluster, uint32_t count = 1);
+  uint8_t extentFind(uint32_t index);
+  bool clusterOf(uint32_t index, uint32_t* cluster);
+#if READ_AHEAD_BLOCKS
+  bool readAhead();
+#endif  // READ_AHEAD_BLOCKS
+  uint32_t clusterIndex(uint32_t pos) {
+    return pos >> (9 + vol_->clusterSizeShift());
+  }
+
+
+  static bool make83Name(const char* str, char* name, const char** ptr); //ya
+  bool setDirSize(uint32_t count); //ya
+
+  // bits defined in flags_
+  // should be 0X0F
+  static uint8_t const F_OFLAG = (O_ACCMODE | O_SYNC);
+  // raw block stream is open on the card
+  static uint8_t const F_STREAM = 0X10;
+  // file is one run of clusters, extent_[0] holds the whole allocation
+  static uint8_t const F_CONTIGUOUS = 0X20;
+  // directory block is pinned in the volume cache
+  static uint8_t const F_DIR_PINNED = 0X40;
+  // sync of directory entry required
+  static uint8_t const F_FILE_DIR_DIRTY = 0X80;
+
+  uint8_t   flags_;         // See above for definition of flags_ bits
+  uint8_t   fstate_;        // error and eof indicator
+  uint8_t   type_;          // type of file see above for values
+  uint8_t   dirIndex_;      // index of directory entry in dirBlock
+};
+
  #endif  //SdBaseFile_h
\ No newline at end of file
@@ -0,0 +1,271 @@
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ * USE_SD_CRC 1 selects small bitwise functions.  Otherwise the functions
+ * use a byte table, in flash on AVR.  Other processors process four bytes
+ * per step with three more tables (slicing-by-4).
+ */
+#include <SdCrc.h>
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define CRC_TABLE_READ(t, i) pgm_read_word(&t[i])
+#define CRC7_TABLE_READ(t, i) pgm_read_byte(&t[i])
+#else  // __AVR__
+#ifndef PROGMEM
+#define PROGMEM
+#endif  // PROGMEM
+#define CRC_TABLE_READ(t, i) t[i]
+#define CRC7_TABLE_READ(t, i) t[i]
+#endif  // __AVR__
+//==============================================================================
+#if USE_SD_CRC == 1
+uint8_t CRC7(const uint8_t* data, uint8_t n) {
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    uint8_t d = data[i];
+    for (uint8_t j = 0; j < 8; j++) {
+      crc <<= 1;
+      if ((d & 0x80) ^ (crc & 0x80)) crc ^= 0x09;
+      d <<= 1;
+    }
+  }
+  return (crc << 1) | 1;
+}
+//------------------------------------------------------------------------------
+// slower CRC-CCITT
+// uses the x^16,x^12,x^5,x^1 polynomial.
+uint16_t CRC_CCITT(const uint8_t *data, size_t n, uint16_t crc) {
+  for (size_t i = 0; i < n; i++) {
+    crc = (uint8_t)(crc >> 8) | (crc << 8);
+    crc ^= data[i];
+    crc ^= (uint8_t)(crc & 0xff) >> 4;
+    crc ^= crc << 12;
+    crc ^= (crc & 0xff) << 5;
+  }
+  return crc;
+}
+#else  // USE_SD_CRC == 1
+//------------------------------------------------------------------------------
+// CRC7 of one byte, shifted left one bit
+static const uint8_t crc7Table[256] PROGMEM = {
+  0X00, 0X12, 0X24, 0X36, 0X48, 0X5A, 0X6C, 0X7E,
+  0X90, 0X82, 0XB4, 0XA6, 0XD8, 0XCA, 0XFC, 0XEE,
+  0X32, 0X20, 0X16, 0X04, 0X7A, 0X68, 0X5E, 0X4C,
+  0XA2, 0XB0, 0X86, 0X94, 0XEA, 0XF8, 0XCE, 0XDC,
+  0X64, 0X76, 0X40, 0X52, 0X2C, 0X3E, 0X08, 0X1A,
+  0XF4, 0XE6, 0XD0, 0XC2, 0XBC, 0XAE, 0X98, 0X8A,
+  0X56, 0X44, 0X72, 0X60, 0X1E, 0X0C, 0X3A, 0X28,
+  0XC6, 0XD4, 0XE2, 0XF0, 0X8E, 0X9C, 0XAA, 0XB8,
+  0XC8, 0XDA, 0XEC, 0XFE, 0X80, 0X92, 0XA4, 0XB6,
+  0X58, 0X4A, 0X7C, 0X6E, 0X10, 0X02, 0X34, 0X26,
+  0XFA, 0XE8, 0XDE, 0XCC, 0XB2, 0XA0, 0X96, 0X84,
+  0X6A, 0X78, 0X4E, 0X5C, 0X22, 0X30, 0X06, 0X14,
+  0XAC, 0XBE, 0X88, 0X9A, 0XE4, 0XF6, 0XC0, 0XD2,
+  0X3C, 0X2E, 0X18, 0X0A, 0X74, 0X66, 0X50, 0X42,
+  0X9E, 0X8C, 0XBA, 0XA8, 0XD6, 0XC4, 0XF2, 0XE0,
+  0X0E, 0X1C, 0X2A, 0X38, 0X46, 0X54, 0X62, 0X70,
+  0X82, 0X90, 0XA6, 0XB4, 0XCA, 0XD8, 0XEE, 0XFC,
+  0X12, 0X00, 0X36, 0X24, 0X5A, 0X48, 0X7E, 0X6C,
+  0XB0, 0XA2, 0X94, 0X86, 0XF8, 0XEA, 0XDC, 0XCE,
+  0X20, 0X32, 0X04, 0X16, 0X68, 0X7A, 0X4C, 0X5E,
+  0XE6, 0XF4, 0XC2, 0XD0, 0XAE, 0XBC, 0X8A, 0X98,
+  0X76, 0X64, 0X52, 0X40, 0X3E, 0X2C, 0X1A, 0X08,
+  0XD4, 0XC6, 0XF0, 0XE2, 0X9C, 0X8E, 0XB8, 0XAA,
+  0X44, 0X56, 0X60, 0X72, 0X0C, 0X1E, 0X28, 0X3A,
+  0X4A, 0X58, 0X6E, 0X7C, 0X02, 0X10, 0X26, 0X34,
+  0XDA, 0XC8, 0XFE, 0XEC, 0X92, 0X80, 0XB6, 0XA4,
+  0X78, 0X6A, 0X5C, 0X4E, 0X30, 0X22, 0X14, 0X06,
+  0XE8, 0XFA, 0XCC, 0XDE, 0XA0, 0XB2, 0X84, 0X96,
+  0X2E, 0X3C, 0X0A, 0X18, 0X66, 0X74, 0X42, 0X50,
+  0XBE, 0XAC, 0X9A, 0X88, 0XF6, 0XE4, 0XD2, 0XC0,
+  0X1C, 0X0E, 0X38, 0X2A, 0X54, 0X46, 0X70, 0X62,
+  0X8C, 0X9E, 0XA8, 0XBA, 0XC4, 0XD6, 0XE0, 0XF2
+};
+//------------------------------------------------------------------------------
+uint8_t CRC7(const uint8_t* data, uint8_t n) {
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    crc = CRC7_TABLE_READ(crc7Table, crc ^ data[i]);
+  }
+  return crc | 1;
+}
+//------------------------------------------------------------------------------
+// CRC-CCITT of one byte
+static const uint16_t crcTable0[256] PROGMEM = {
+  0X0000, 0X1021, 0X2042, 0X3063, 0X4084, 0X50A5, 0X60C6, 0X70E7,
+  0X8108, 0X9129, 0XA14A, 0XB16B, 0XC18C, 0XD1AD, 0XE1CE, 0XF1EF,
+  0X1231, 0X0210, 0X3273, 0X2252, 0X52B5, 0X4294, 0X72F7, 0X62D6,
+  0X9339, 0X8318, 0XB37B, 0XA35A, 0XD3BD, 0XC39C, 0XF3FF, 0XE3DE,
+  0X2462, 0X3443, 0X0420, 0X1401, 0X64E6, 0X74C7, 0X44A4, 0X5485,
+  0XA56A, 0XB54B, 0X8528, 0X9509, 0XE5EE, 0XF5CF, 0XC5AC, 0XD58D,
+  0X3653, 0X2672, 0X1611, 0X0630, 0X76D7, 0X66F6, 0X5695, 0X46B4,
+  0XB75B, 0XA77A, 0X9719, 0X8738, 0XF7DF, 0XE7FE, 0XD79D, 0XC7BC,
+  0X48C4, 0X58E5, 0X6886, 0X78A7, 0X0840, 0X1861, 0X2802, 0X3823,
+  0XC9CC, 0XD9ED, 0XE98E, 0XF9AF, 0X8948, 0X9969, 0XA90A, 0XB92B,
+  0X5AF5, 0X4AD4, 0X7AB7, 0X6A96, 0X1A71, 0X0A50, 0X3A33, 0X2A12,
+  0XDBFD, 0XCBDC, 0XFBBF, 0XEB9E, 0X9B79, 0X8B58, 0XBB3B, 0XAB1A,
+  0X6CA6, 0X7C87, 0X4CE4, 0X5CC5, 0X2C22, 0X3C03, 0X0C60, 0X1C41,
+  0XEDAE, 0XFD8F, 0XCDEC, 0XDDCD, 0XAD2A, 0XBD0B, 0X8D68, 0X9D49,
+  0X7E97, 0X6EB6, 0X5ED5, 0X4EF4, 0X3E13, 0X2E32, 0X1E51, 0X0E70,
+  0XFF9F, 0XEFBE, 0XDFDD, 0XCFFC, 0XBF1B, 0XAF3A, 0X9F59, 0X8F78,
+  0X9188, 0X81A9, 0XB1CA, 0XA1EB, 0XD10C, 0XC12D, 0XF14E, 0XE16F,
+  0X1080, 0X00A1, 0X30C2, 0X20E3, 0X5004, 0X4025, 0X7046, 0X6067,
+  0X83B9, 0X9398, 0XA3FB, 0XB3DA, 0XC33D, 0XD31C, 0XE37F, 0XF35E,
+  0X02B1, 0X1290, 0X22F3, 0X32D2, 0X4235, 0X5214, 0X6277, 0X7256,
+  0XB5EA, 0XA5CB, 0X95A8, 0X8589, 0XF56E, 0XE54F, 0XD52C, 0XC50D,
+  0X34E2, 0X24C3, 0X14A0, 0X0481, 0X7466, 0X6447, 0X5424, 0X4405,
+  0XA7DB, 0XB7FA, 0X8799, 0X97B8, 0XE75F, 0XF77E, 0XC71D, 0XD73C,
+  0X26D3, 0X36F2, 0X0691, 0X16B0, 0X6657, 0X7676, 0X4615, 0X5634,
+  0XD94C, 0XC96D, 0XF90E, 0XE92F, 0X99C8, 0X89E9, 0XB98A, 0XA9AB,
+  0X5844, 0X4865, 0X7806, 0X6827, 0X18C0, 0X08E1, 0X3882, 0X28A3,
+  0XCB7D, 0XDB5C, 0XEB3F, 0XFB1E, 0X8BF9, 0X9BD8, 0XABBB, 0XBB9A,
+  0X4A75, 0X5A54, 0X6A37, 0X7A16, 0X0AF1, 0X1AD0, 0X2AB3, 0X3A92,
+  0XFD2E, 0XED0F, 0XDD6C, 0XCD4D, 0XBDAA, 0XAD8B, 0X9DE8, 0X8DC9,
+  0X7C26, 0X6C07, 0X5C64, 0X4C45, 0X3CA2, 0X2C83, 0X1CE0, 0X0CC1,
+  0XEF1F, 0XFF3E, 0XCF5D, 0XDF7C, 0XAF9B, 0XBFBA, 0X8FD9, 0X9FF8,
+  0X6E17, 0X7E36, 0X4E55, 0X5E74, 0X2E93, 0X3EB2, 0X0ED1, 0X1EF0
+};
+#ifdef __AVR__
+//------------------------------------------------------------------------------
+uint16_t CRC_CCITT(const uint8_t* data, size_t n, uint16_t crc) {
+  for (size_t i = 0; i < n; i++) {
+    crc = CRC_TABLE_READ(crcTable0, (crc >> 8) ^ data[i]) ^ (crc << 8);
+  }
+  return crc;
+}
+#else  // __AVR__
+//------------------------------------------------------------------------------
+// crcTableK[b] is the CRC of byte b followed by K zero bytes
+static const uint16_t crcTable1[256] = {
+  0X0000, 0X3331, 0X6662, 0X5553, 0XCCC4, 0XFFF5, 0XAAA6, 0X9997,
+  0X89A9, 0XBA98, 0XEFCB, 0XDCFA, 0X456D, 0X765C, 0X230F, 0X103E,
+  0X0373, 0X3042, 0X6511, 0X5620, 0XCFB7, 0XFC86, 0XA9D5, 0X9AE4,
+  0X8ADA, 0XB9EB, 0XECB8, 0XDF89, 0X461E, 0X752F, 0X207C, 0X134D,
+  0X06E6, 0X35D7, 0X6084, 0X53B5, 0XCA22, 0XF913, 0XAC40, 0X9F71,
+  0X8F4F, 0XBC7E, 0XE92D, 0XDA1C, 0X438B, 0X70BA, 0X25E9, 0X16D8,
+  0X0595, 0X36A4, 0X63F7, 0X50C6, 0XC951, 0XFA60, 0XAF33, 0X9C02,
+  0X8C3C, 0XBF0D, 0XEA5E, 0XD96F, 0X40F8, 0X73C9, 0X269A, 0X15AB,
+  0X0DCC, 0X3EFD, 0X6BAE, 0X589F, 0XC108, 0XF239, 0XA76A, 0X945B,
+  0X8465, 0XB754, 0XE207, 0XD136, 0X48A1, 0X7B90, 0X2EC3, 0X1DF2,
+  0X0EBF, 0X3D8E, 0X68DD, 0X5BEC, 0XC27B, 0XF14A, 0XA419, 0X9728,
+  0X8716, 0XB427, 0XE174, 0XD245, 0X4BD2, 0X78E3, 0X2DB0, 0X1E81,
+  0X0B2A, 0X381B, 0X6D48, 0X5E79, 0XC7EE, 0XF4DF, 0XA18C, 0X92BD,
+  0X8283, 0XB1B2, 0XE4E1, 0XD7D0, 0X4E47, 0X7D76, 0X2825, 0X1B14,
+  0X0859, 0X3B68, 0X6E3B, 0X5D0A, 0XC49D, 0XF7AC, 0XA2FF, 0X91CE,
+  0X81F0, 0XB2C1, 0XE792, 0XD4A3, 0X4D34, 0X7E05, 0X2B56, 0X1867,
+  0X1B98, 0X28A9, 0X7DFA, 0X4ECB, 0XD75C, 0XE46D, 0XB13E, 0X820F,
+  0X9231, 0XA100, 0XF453, 0XC762, 0X5EF5, 0X6DC4, 0X3897, 0X0BA6,
+  0X18EB, 0X2BDA, 0X7E89, 0X4DB8, 0XD42F, 0XE71E, 0XB24D, 0X817C,
+  0X9142, 0XA273, 0XF720, 0XC411, 0X5D86, 0X6EB7, 0X3BE4, 0X08D5,
+  0X1D7E, 0X2E4F, 0X7B1C, 0X482D, 0XD1BA, 0XE28B, 0XB7D8, 0X84E9,
+  0X94D7, 0XA7E6, 0XF2B5, 0XC184, 0X5813, 0X6B22, 0X3E71, 0X0D40,
+  0X1E0D, 0X2D3C, 0X786F, 0X4B5E, 0XD2C9, 0XE1F8, 0XB4AB, 0X879A,
+  0X97A4, 0XA495, 0XF1C6, 0XC2F7, 0X5B60, 0X6851, 0X3D02, 0X0E33,
+  0X1654, 0X2565, 0X7036, 0X4307, 0XDA90, 0XE9A1, 0XBCF2, 0X8FC3,
+  0X9FFD, 0XACCC, 0XF99F, 0XCAAE, 0X5339, 0X6008, 0X355B, 0X066A,
+  0X1527, 0X2616, 0X7345, 0X4074, 0XD9E3, 0XEAD2, 0XBF81, 0X8CB0,
+  0X9C8E, 0XAFBF, 0XFAEC, 0XC9DD, 0X504A, 0X637B, 0X3628, 0X0519,
+  0X10B2, 0X2383, 0X76D0, 0X45E1, 0XDC76, 0XEF47, 0XBA14, 0X8925,
+  0X991B, 0XAA2A, 0XFF79, 0XCC48, 0X55DF, 0X66EE, 0X33BD, 0X008C,
+  0X13C1, 0X20F0, 0X75A3, 0X4692, 0XDF05, 0XEC34, 0XB967, 0X8A56,
+  0X9A68, 0XA959, 0XFC0A, 0XCF3B, 0X56AC, 0X659D, 0X30CE, 0X03FF
+};
+static const uint16_t crcTable2[256] = {
+  0X0000, 0X3730, 0X6E60, 0X5950, 0XDCC0, 0XEBF0, 0XB2A0, 0X8590,
+  0XA9A1, 0X9E91, 0XC7C1, 0XF0F1, 0X7561, 0X4251, 0X1B01, 0X2C31,
+  0X4363, 0X7453, 0X2D03, 0X1A33, 0X9FA3, 0XA893, 0XF1C3, 0XC6F3,
+  0XEAC2, 0XDDF2, 0X84A2, 0XB392, 0X3602, 0X0132, 0X5862, 0X6F52,
+  0X86C6, 0XB1F6, 0XE8A6, 0XDF96, 0X5A06, 0X6D36, 0X3466, 0X0356,
+  0X2F67, 0X1857, 0X4107, 0X7637, 0XF3A7, 0XC497, 0X9DC7, 0XAAF7,
+  0XC5A5, 0XF295, 0XABC5, 0X9CF5, 0X1965, 0X2E55, 0X7705, 0X4035,
+  0X6C04, 0X5B34, 0X0264, 0X3554, 0XB0C4, 0X87F4, 0XDEA4, 0XE994,
+  0X1DAD, 0X2A9D, 0X73CD, 0X44FD, 0XC16D, 0XF65D, 0XAF0D, 0X983D,
+  0XB40C, 0X833C, 0XDA6C, 0XED5C, 0X68CC, 0X5FFC, 0X06AC, 0X319C,
+  0X5ECE, 0X69FE, 0X30AE, 0X079E, 0X820E, 0XB53E, 0XEC6E, 0XDB5E,
+  0XF76F, 0XC05F, 0X990F, 0XAE3F, 0X2BAF, 0X1C9F, 0X45CF, 0X72FF,
+  0X9B6B, 0XAC5B, 0XF50B, 0XC23B, 0X47AB, 0X709B, 0X29CB, 0X1EFB,
+  0X32CA, 0X05FA, 0X5CAA, 0X6B9A, 0XEE0A, 0XD93A, 0X806A, 0XB75A,
+  0XD808, 0XEF38, 0XB668, 0X8158, 0X04C8, 0X33F8, 0X6AA8, 0X5D98,
+  0X71A9, 0X4699, 0X1FC9, 0X28F9, 0XAD69, 0X9A59, 0XC309, 0XF439,
+  0X3B5A, 0X0C6A, 0X553A, 0X620A, 0XE79A, 0XD0AA, 0X89FA, 0XBECA,
+  0X92FB, 0XA5CB, 0XFC9B, 0XCBAB, 0X4E3B, 0X790B, 0X205B, 0X176B,
+  0X7839, 0X4F09, 0X1659, 0X2169, 0XA4F9, 0X93C9, 0XCA99, 0XFDA9,
+  0XD198, 0XE6A8, 0XBFF8, 0X88C8, 0X0D58, 0X3A68, 0X6338, 0X5408,
+  0XBD9C, 0X8AAC, 0XD3FC, 0XE4CC, 0X615C, 0X566C, 0X0F3C, 0X380C,
+  0X143D, 0X230D, 0X7A5D, 0X4D6D, 0XC8FD, 0XFFCD, 0XA69D, 0X91AD,
+  0XFEFF, 0XC9CF, 0X909F, 0XA7AF, 0X223F, 0X150F, 0X4C5F, 0X7B6F,
+  0X575E, 0X606E, 0X393E, 0X0E0E, 0X8B9E, 0XBCAE, 0XE5FE, 0XD2CE,
+  0X26F7, 0X11C7, 0X4897, 0X7FA7, 0XFA37, 0XCD07, 0X9457, 0XA367,
+  0X8F56, 0XB866, 0XE136, 0XD606, 0X5396, 0X64A6, 0X3DF6, 0X0AC6,
+  0X6594, 0X52A4, 0X0BF4, 0X3CC4, 0XB954, 0X8E64, 0XD734, 0XE004,
+  0XCC35, 0XFB05, 0XA255, 0X9565, 0X10F5, 0X27C5, 0X7E95, 0X49A5,
+  0XA031, 0X9701, 0XCE51, 0XF961, 0X7CF1, 0X4BC1, 0X1291, 0X25A1,
+  0X0990, 0X3EA0, 0X67F0, 0X50C0, 0XD550, 0XE260, 0XBB30, 0X8C00,
+  0XE352, 0XD462, 0X8D32, 0XBA02, 0X3F92, 0X08A2, 0X51F2, 0X66C2,
+  0X4AF3, 0X7DC3, 0X2493, 0X13A3, 0X9633, 0XA103, 0XF853, 0XCF63
+};
+static const uint16_t crcTable3[256] = {
+  0X0000, 0X76B4, 0XED68, 0X9BDC, 0XCAF1, 0XBC45, 0X2799, 0X512D,
+  0X85C3, 0XF377, 0X68AB, 0X1E1F, 0X4F32, 0X3986, 0XA25A, 0XD4EE,
+  0X1BA7, 0X6D13, 0XF6CF, 0X807B, 0XD156, 0XA7E2, 0X3C3E, 0X4A8A,
+  0X9E64, 0XE8D0, 0X730C, 0X05B8, 0X5495, 0X2221, 0XB9FD, 0XCF49,
+  0X374E, 0X41FA, 0XDA26, 0XAC92, 0XFDBF, 0X8B0B, 0X10D7, 0X6663,
+  0XB28D, 0XC439, 0X5FE5, 0X2951, 0X787C, 0X0EC8, 0X9514, 0XE3A0,
+  0X2CE9, 0X5A5D, 0XC181, 0XB735, 0XE618, 0X90AC, 0X0B70, 0X7DC4,
+  0XA92A, 0XDF9E, 0X4442, 0X32F6, 0X63DB, 0X156F, 0X8EB3, 0XF807,
+  0X6E9C, 0X1828, 0X83F4, 0XF540, 0XA46D, 0XD2D9, 0X4905, 0X3FB1,
+  0XEB5F, 0X9DEB, 0X0637, 0X7083, 0X21AE, 0X571A, 0XCCC6, 0XBA72,
+  0X753B, 0X038F, 0X9853, 0XEEE7, 0XBFCA, 0XC97E, 0X52A2, 0X2416,
+  0XF0F8, 0X864C, 0X1D90, 0X6B24, 0X3A09, 0X4CBD, 0XD761, 0XA1D5,
+  0X59D2, 0X2F66, 0XB4BA, 0XC20E, 0X9323, 0XE597, 0X7E4B, 0X08FF,
+  0XDC11, 0XAAA5, 0X3179, 0X47CD, 0X16E0, 0X6054, 0XFB88, 0X8D3C,
+  0X4275, 0X34C1, 0XAF1D, 0XD9A9, 0X8884, 0XFE30, 0X65EC, 0X1358,
+  0XC7B6, 0XB102, 0X2ADE, 0X5C6A, 0X0D47, 0X7BF3, 0XE02F, 0X969B,
+  0XDD38, 0XAB8C, 0X3050, 0X46E4, 0X17C9, 0X617D, 0XFAA1, 0X8C15,
+  0X58FB, 0X2E4F, 0XB593, 0XC327, 0X920A, 0XE4BE, 0X7F62, 0X09D6,
+  0XC69F, 0XB02B, 0X2BF7, 0X5D43, 0X0C6E, 0X7ADA, 0XE106, 0X97B2,
+  0X435C, 0X35E8, 0XAE34, 0XD880, 0X89AD, 0XFF19, 0X64C5, 0X1271,
+  0XEA76, 0X9CC2, 0X071E, 0X71AA, 0X2087, 0X5633, 0XCDEF, 0XBB5B,
+  0X6FB5, 0X1901, 0X82DD, 0XF469, 0XA544, 0XD3F0, 0X482C, 0X3E98,
+  0XF1D1, 0X8765, 0X1CB9, 0X6A0D, 0X3B20, 0X4D94, 0XD648, 0XA0FC,
+  0X7412, 0X02A6, 0X997A, 0XEFCE, 0XBEE3, 0XC857, 0X538B, 0X253F,
+  0XB3A4, 0XC510, 0X5ECC, 0X2878, 0X7955, 0X0FE1, 0X943D, 0XE289,
+  0X3667, 0X40D3, 0XDB0F, 0XADBB, 0XFC96, 0X8A22, 0X11FE, 0X674A,
+  0XA803, 0XDEB7, 0X456B, 0X33DF, 0X62F2, 0X1446, 0X8F9A, 0XF92E,
+  0X2DC0, 0X5B74, 0XC0A8, 0XB61C, 0XE731, 0X9185, 0X0A59, 0X7CED,
+  0X84EA, 0XF25E, 0X6982, 0X1F36, 0X4E1B, 0X38AF, 0XA373, 0XD5C7,
+  0X0129, 0X779D, 0XEC41, 0X9AF5, 0XCBD8, 0XBD6C, 0X26B0, 0X5004,
+  0X9F4D, 0XE9F9, 0X7225, 0X0491, 0X55BC, 0X2308, 0XB8D4, 0XCE60,
+  0X1A8E, 0X6C3A, 0XF7E6, 0X8152, 0XD07F, 0XA6CB, 0X3D17, 0X4BA3
+};
+//------------------------------------------------------------------------------
+uint16_t CRC_CCITT(const uint8_t* data, size_t n, uint16_t crc) {
+  // the CRC so far is added to the first two bytes of each group
+  for (; n >= 4; n -= 4, data += 4) {
+    crc = crcTable3[(crc >> 8) ^ data[0]] ^ crcTable2[(crc & 0XFF) ^ data[1]]
+        ^ crcTable1[data[2]] ^ crcTable0[data[3]];
+  }
+  for (; n > 0; n--) {
+    crc = crcTable0[(crc >> 8) ^ *data++] ^ (crc << 8);
+  }
+  return crc;
+}
+#endif  // __AVR__
+#endif  // USE_SD_CRC == 1
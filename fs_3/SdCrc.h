@@ -0,0 +1,51 @@
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef SdCrc_h
+#define SdCrc_h
+/**
+ * \file
+ * \brief CRC7 and CRC-CCITT checksums used on the SD SPI bus
+ */
+#include <SdPfsConfig.h>
+#include <stddef.h>
+//------------------------------------------------------------------------------
+/**
+ * CRC7 of a command, polynomial x^7 + x^3 + 1.
+ *
+ * \param[in] data Command and argument bytes.
+ * \param[in] n Number of bytes.
+ *
+ * \return The CRC shifted left one bit with the end bit set, the last
+ * byte of an SD command.
+ */
+uint8_t CRC7(const uint8_t* data, uint8_t n);
+/**
+ * CRC-CCITT (XModem) of a data block, polynomial x^16 + x^12 + x^5 + 1
+ * with a zero initial value.
+ *
+ * \param[in] data Bytes to check.
+ * \param[in] n Number of bytes.
+ * \param[in] crc CRC of the bytes before \a data, to check a block in
+ * pieces.
+ *
+ * \return The CRC sent after a data block.
+ */
+uint16_t CRC_CCITT(const uint8_t* data, size_t n, uint16_t crc = 0);
+#endif  // SdCrc_h
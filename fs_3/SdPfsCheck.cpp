@@ -0,0 +1,510 @@
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#include <SdPfsCheck.h>
+#include <stdlib.h>
+#if USE_HOST_SD_CARD
+#include <pthread.h>
+#include <unistd.h>
+#endif  // USE_HOST_SD_CARD
+// macro for debug
+#define DBG_FAIL_MACRO  //  Serial.print(__FILE__);Serial.println(__LINE__)
+//------------------------------------------------------------------------------
+// Mark the used clusters of the table block for clusters [cluster,
+// cluster + 128) in map and count them.  Clusters past last have no data.
+static void scanBlock(const uint32_t* entries, uint32_t cluster,
+                      uint32_t last, uint32_t* map, PfsCheck_t* counts) {
+  for (uint16_t i = 0; i < 128 && cluster <= last; i++, cluster++) {
+    // skip reserved entries 0 and 1
+    if (cluster < 2) continue;
+    uint32_t v = entries[i] & PFSMASK;
+    if (v == 0) {
+      counts->freeClusters++;
+      continue;
+    }
+    map[cluster >> 5] |= 1UL << (cluster & 31);
+    counts->usedClusters++;
+    if (v < 2 || (v > last && v < PFSEOC_MIN)) counts->badEntries++;
+  }
+}
+//------------------------------------------------------------------------------
+#if USE_HOST_SD_CARD
+// table blocks read by one thread
+struct PfsScanJob_t {
+  int fd;               // image file
+  uint32_t lba;         // first table block of the job
+  uint32_t cluster;     // cluster of the first entry in it
+  uint32_t blocks;      // number of table blocks
+  uint32_t last;        // last cluster of the volume
+  uint32_t* map;        // bitmap of used clusters
+  PfsCheck_t counts;    // clusters found by the job
+  bool thread;          // job runs on its own thread
+  bool ok;
+};
+// table blocks read with each pread()
+uint16_t const SCAN_CHUNK_BLOCKS = 64;
+
+// Scan the blocks of a job.  Each table block sets its own four words of
+// the bitmap so jobs need no lock.
+static void* scanWorker(void* arg) {
+  PfsScanJob_t* job = reinterpret_cast<PfsScanJob_t*>(arg);
+  uint32_t* buf = reinterpret_cast<uint32_t*>(malloc(512*SCAN_CHUNK_BLOCKS));
+  uint32_t done = 0;
+  job->ok = false;
+  if (!buf) return 0;
+  while (done < job->blocks) {
+    uint32_t n = job->blocks - done;
+    if (n > SCAN_CHUNK_BLOCKS) n = SCAN_CHUNK_BLOCKS;
+    if (pread(job->fd, buf, 512*n, 512*(off_t)(job->lba + done)) !=
+        (ssize_t)(512*n)) {
+      free(buf);
+      return 0;
+    }
+    for (uint32_t b = 0; b < n; b++) {
+      scanBlock(buf + 128*b, job->cluster + 128*(done + b), job->last,
+                job->map, &job->counts);
+    }
+    done += n;
+  }
+  free(buf);
+  job->ok = true;
+  return 0;
+}
+#endif  // USE_HOST_SD_CARD
+//==============================================================================
+// SdPfsCheck member functions
+//------------------------------------------------------------------------------
+/**
+ * Check the volume and optionally repair it.
+ *
+ * \param[in] vol A mounted volume with no open files.
+ * \param[in] repair True to fix the faults found, see SdPfsCheck.
+ *
+ * Counts are available from result() and faults() after a successful
+ * check.  A repaired volume is synced.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned if the volume can't be read, there
+ * is no memory for the bitmaps or the root directory is unusable.
+ */
+bool SdPfsCheck::check(SdVolume* vol, bool repair) {
+  uint32_t count;
+  uint8_t fault;
+  int32_t freeCount;
+  vol_ = vol;
+  repair_ = repair && !ENABLED_READ_ONLY;
+  memset(&result_, 0, sizeof(result_));
+  if (!scanTable()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // the root can't be rebuilt
+  if (!checkDir(vol_->rootDirStart(), 2, &count, &fault) || count == 0) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (repair_) vol_->rootClusterCount_ = count;
+  if (!checkLost()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  freeCount = result_.freeClusters;
+  if (repair_) freeCount += result_.lostClusters;
+  if (vol_->freeCount_ >= 0 && vol_->freeCount_ != freeCount) {
+    result_.freeCountBad = true;
+    if (repair_) {
+      vol_->freeCount_ = freeCount;
+      vol_->infoDirty_ = true;
+    }
+  }
+  if (repair_ && (result_.repaired || result_.freeCountBad)) {
+#if DIR_HASH_SIZE
+    // entries may have been removed
+    vol_->dirHashClear(0);
+#endif  // DIR_HASH_SIZE
+    if (!vol_->sync()) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  clear();
+  return true;
+
+ fail:
+  clear();
+  return false;
+}
+//------------------------------------------------------------------------------
+// Check the chain of the directory at cluster and, if depth is nonzero,
+// the entries in it with one less depth.  Return the clusters kept in
+// count and the fault that ended the chain in fault.
+bool SdPfsCheck::checkDir(uint32_t cluster, uint8_t depth, uint32_t* count,
+                          uint8_t* fault) {
+  bool adjacent;
+  result_.dirs++;
+  if (!walk(cluster, 0, count, &adjacent, fault)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  countFault(*fault);
+  if (depth == 0) return true;
+  // entries are only read from the clusters kept
+  for (uint32_t k = 0; k < *count; k++) {
+    if (k && !vol_->pfsGet(cluster, &cluster)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    uint32_t block = vol_->clusterStartBlock(cluster);
+    for (uint8_t b = 0; b < vol_->blocksPerCluster(); b++, block++) {
+      for (uint8_t i = 0; i < 16; i++) {
+        // checkEntry() uses the cache so the block is fetched each time
+        cache_t* pc = vol_->cacheFetch(block, SdVolume::CACHE_FOR_READ);
+        if (!pc) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+        dir_t* p = pc->dir + i;
+        // done if past last used entry
+        if (p->name[0] == DIR_NAME_FREE) return true;
+        // skip deleted entry, '.' and '..'
+        if (p->name[0] == DIR_NAME_DELETED || p->name[0] == '.') continue;
+        if (!DIR_IS_FILE_OR_SUBDIR(p)) continue;
+        if (!checkEntry(block, i, depth - 1)) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+      }
+    }
+  }
+  return true;
+
+ fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+// Check the chain of entry index in block against its size.  A
+// subdirectory is checked by checkDir() with depth.
+bool SdPfsCheck::checkEntry(uint32_t block, uint8_t index, uint8_t depth) {
+  uint8_t shift = 9 + vol_->clusterSizeShift();
+  uint32_t count;
+  uint32_t keep;
+  uint8_t fault;
+  bool adjacent;
+  bool contiguous;
+  bool dirty = false;
+  dir_t d;
+  cache_t* pc = vol_->cacheFetch(block, SdVolume::CACHE_FOR_READ);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  d = pc->dir[index];
+  if (DIR_IS_SUBDIR(&d)) {
+    if (d.firstCluster == 0) {
+      count = 0;
+      result_.badChains++;
+    } else if (!checkDir(d.firstCluster, depth, &count, &fault)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (count == 0) {
+      // nothing is left of the directory
+      d.name[0] = DIR_NAME_DELETED;
+      dirty = true;
+    } else if (d.clusterCount && d.clusterCount != count) {
+      if (fault == WALK_OK) result_.sizeErrors++;
+      d.clusterCount = count;
+      dirty = true;
+    }
+    goto done;
+  }
+  result_.files++;
+  contiguous = d.pfsFlags & DIR_PFS_CONTIGUOUS;
+  keep = contiguous ? d.clusterCount : (d.fileSize >> shift)
+         + ((d.fileSize & ((1UL << shift) - 1)) != 0);
+  if (d.firstCluster == 0) {
+    if (d.fileSize == 0 && !contiguous) goto done;
+    result_.sizeErrors++;
+    count = 0;
+  } else if (keep == 0) {
+    // clusters of an empty file, as left by a write that was not synced
+    result_.sizeErrors++;
+    count = 0;
+  } else {
+    if (!walk(d.firstCluster, keep, &count, &adjacent, &fault)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    countFault(fault);
+    if (contiguous && (!adjacent || count != d.clusterCount)) {
+      if (fault == WALK_OK) result_.sizeErrors++;
+      if (adjacent) {
+        d.clusterCount = count;
+      } else {
+        d.pfsFlags &= ~DIR_PFS_CONTIGUOUS;
+        d.clusterCount = 0;
+      }
+      dirty = true;
+    }
+    if (count && d.fileSize && ((d.fileSize - 1) >> shift) >= count) {
+      if (fault == WALK_OK) result_.sizeErrors++;
+      d.fileSize = count << shift;
+      dirty = true;
+    }
+  }
+  if (count == 0) {
+    // the file is empty, a chain of its clusters is lost
+    d.firstCluster = 0;
+    d.fileSize = 0;
+    d.pfsFlags &= ~DIR_PFS_CONTIGUOUS;
+    d.clusterCount = 0;
+    dirty = true;
+  }
+
+ done:
+  if (dirty && repair_ && !putEntry(block, index, &d)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  return true;
+
+ fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+// Count used clusters no chain reached and free them for repair.  Only
+// table blocks with such clusters are read.
+bool SdPfsCheck::checkLost() {
+  uint32_t last = vol_->clusterCount() + 1;
+  uint32_t words = (last + 32) >> 5;
+  uint32_t lost = result_.lostClusters;
+  for (uint32_t w = 0; w < words; w += 4) {
+    uint32_t any = 0;
+    for (uint8_t j = 0; j < 4 && (w + j) < words; j++) {
+      any |= used_[w + j] & ~seen_[w + j];
+    }
+    if (!any) continue;
+    uint32_t cluster = w << 5;
+    cache_t* pc = vol_->cacheFetchPfs(vol_->pfsStartBlock() + (cluster >> 7),
+                                      SdVolume::CACHE_FOR_READ);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // a lost chain ends with an EOC entry
+    for (uint8_t i = 0; i < 128 && (cluster + i) <= last; i++) {
+      uint32_t c = cluster + i;
+      if (!isSet(used_, c) || isSet(seen_, c)) continue;
+      result_.lostClusters++;
+      if (vol_->isEOC(pc->fat32[i] & PFSMASK)) result_.lostChains++;
+    }
+    if (!repair_) continue;
+    // free each run of lost clusters in the block at once
+    for (uint8_t i = 0; i < 128 && (cluster + i) <= last;) {
+      uint32_t c = cluster + i;
+      if (!isSet(used_, c) || isSet(seen_, c)) {
+        i++;
+        continue;
+      }
+      uint8_t n = 1;
+      while ((i + n) < 128 && (c + n) <= last && isSet(used_, c + n)
+        && !isSet(seen_, c + n)) {
+        n++;
+      }
+      if (!vol_->infoMarkStale() || !vol_->pfsFreeRange(c, n)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      vol_->journalFree(c, n);
+      if (c < vol_->allocSearchStart_) vol_->allocSearchStart_ = c;
+      result_.repaired++;
+      i += n;
+    }
+  }
+  // the chain of a loop has no EOC
+  if (result_.lostClusters > lost && result_.lostChains == 0) {
+    result_.lostChains = 1;
+  }
+  return true;
+
+ fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+void SdPfsCheck::clear() {
+  free(used_);
+  free(seen_);
+  used_ = seen_ = 0;
+}
+//------------------------------------------------------------------------------
+void SdPfsCheck::countFault(uint8_t fault) {
+  if (fault == WALK_BAD) {
+    result_.badChains++;
+  } else if (fault == WALK_CROSS) {
+    result_.crossLinks++;
+  } else if (fault == WALK_LONG) {
+    result_.sizeErrors++;
+  }
+}
+//------------------------------------------------------------------------------
+// Replace entry index in block with d.
+bool SdPfsCheck::putEntry(uint32_t block, uint8_t index, const dir_t* d) {
+  cache_t* pc = vol_->cacheFetch(block, SdVolume::CACHE_FOR_LOG);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  pc->dir[index] = *d;
+  vol_->cacheLog(vol_->cacheCurrent_, 32*index, 32);
+  result_.repaired++;
+  return true;
+
+ fail:
+  return false;
+}
+//------------------------------------------------------------------------------
+// Read the table once into used_.  The cache is written first so the
+// table on the card is current.
+bool SdPfsCheck::scanTable() {
+  uint32_t last = vol_->clusterCount() + 1;
+  uint32_t words = (last + 32) >> 5;
+  uint32_t blocks = (last + 128) >> 7;
+  uint32_t lba = vol_->pfsStartBlock();
+  clear();
+  // rounded up to whole table blocks for scanBlock()
+  words = (words + 3) & ~3UL;
+  used_ = reinterpret_cast<uint32_t*>(calloc(words, 4));
+  seen_ = reinterpret_cast<uint32_t*>(calloc(words, 4));
+  if (!used_ || !seen_ || !vol_->cacheSync() || !vol_->cardIdle()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if USE_HOST_SD_CARD
+  {
+    long threads = PFS_CHECK_THREADS;
+    if (threads == 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > (long)(blocks/SCAN_CHUNK_BLOCKS)) {
+      threads = blocks/SCAN_CHUNK_BLOCKS;
+    }
+    if (threads > 1 && vol_->sdCard()->fd() >= 0) {
+      PfsScanJob_t* job = reinterpret_cast<PfsScanJob_t*>(
+                          calloc(threads, sizeof(PfsScanJob_t)));
+      pthread_t* tid = reinterpret_cast<pthread_t*>(
+                       calloc(threads, sizeof(pthread_t)));
+      if (job && tid) {
+        bool ok = true;
+        uint32_t first = 0;
+        for (long t = 0; t < threads; t++) {
+          job[t].fd = vol_->sdCard()->fd();
+          job[t].lba = lba + first;
+          job[t].cluster = first << 7;
+          job[t].blocks = (blocks - first)/(threads - t);
+          job[t].last = last;
+          job[t].map = used_;
+          first += job[t].blocks;
+          // a job that can't be started runs on this thread
+          job[t].thread = !pthread_create(&tid[t], 0, scanWorker, &job[t]);
+          if (!job[t].thread) scanWorker(&job[t]);
+        }
+        for (long t = 0; t < threads; t++) {
+          if (job[t].thread) pthread_join(tid[t], 0);
+          ok = ok && job[t].ok;
+          result_.usedClusters += job[t].counts.usedClusters;
+          result_.freeClusters += job[t].counts.freeClusters;
+          result_.badEntries += job[t].counts.badEntries;
+        }
+        free(job);
+        free(tid);
+        if (!ok) {
+          DBG_FAIL_MACRO;
+          goto fail;
+        }
+        return true;
+      }
+      free(job);
+      free(tid);
+    }
+  }
+#endif  // USE_HOST_SD_CARD
+  for (uint32_t b = 0; b < blocks; b++) {
+    cache_t* pc = vol_->cacheFetchPfs(lba + b, SdVolume::CACHE_FOR_READ);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    scanBlock(pc->fat32, b << 7, last, used_, &result_);
+  }
+  return true;
+
+ fail:
+  clear();
+  return false;
+}
+//------------------------------------------------------------------------------
+// Follow the chain at cluster and mark its clusters seen.  The chain ends
+// at a cluster that is invalid, free or seen before, or after keep
+// clusters if keep is nonzero.  Return the clusters kept in count and
+// whether they are adjacent in adjacent.  With repair the chain is cut
+// after the last cluster kept.
+bool SdPfsCheck::walk(uint32_t cluster, uint32_t keep, uint32_t* count,
+                      bool* adjacent, uint8_t* fault) {
+  uint32_t last = vol_->clusterCount() + 1;
+  uint32_t prev = 0;
+  uint32_t next;
+  *count = 0;
+  *adjacent = true;
+  *fault = WALK_OK;
+  while (true) {
+    if (cluster < 2 || cluster > last || !isSet(used_, cluster)) {
+      *fault = WALK_BAD;
+      break;
+    }
+    // a loop in the chain is seen before too
+    if (isSet(seen_, cluster)) {
+      *fault = WALK_CROSS;
+      break;
+    }
+    seen_[cluster >> 5] |= 1UL << (cluster & 31);
+    ++*count;
+    if (!vol_->pfsGet(cluster, &next)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (vol_->isEOC(next)) return true;
+    prev = cluster;
+    if (*count == keep) {
+      *fault = WALK_LONG;
+      break;
+    }
+    if (next != cluster + 1) *adjacent = false;
+    cluster = next;
+  }
+  // the rest of the chain is found lost or belongs to another chain
+  if (repair_ && prev) {
+    if (!vol_->pfsPutEOC(prev)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    result_.repaired++;
+  }
+  return true;
+
+ fail:
+  return false;
+}
@@ -0,0 +1,102 @@
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+#ifndef SdPfsCheck_h
+#define SdPfsCheck_h
+/**
+ * \file
+ * \brief Consistency check and repair of a PFS volume
+ */
+#include <string.h>
+#include <SdVolume.h>
+//------------------------------------------------------------------------------
+// counts found by SdPfsCheck::check()
+struct PfsCheck_t {
+  uint32_t files;         // file entries checked
+  uint32_t dirs;          // directories checked, root included
+  uint32_t usedClusters;  // clusters in use in the table
+  uint32_t freeClusters;  // free clusters in the table
+  uint32_t badEntries;    // table entries that are not a cluster or EOC
+  uint32_t badChains;     // chains that run into a free or invalid cluster
+  uint32_t crossLinks;    // chains that run into another chain or loop
+  uint32_t sizeErrors;    // entries whose size does not match the chain
+  uint32_t lostChains;    // chains no entry refers to
+  uint32_t lostClusters;  // clusters in them
+  bool     freeCountBad;  // free count kept by the volume is wrong
+  uint32_t repaired;      // entries and chains changed by the repair
+};
+//------------------------------------------------------------------------------
+/**
+ * \class SdPfsCheck
+ * \brief Check the PFS table against the entries of the root directory
+ * and of its subdirectories.
+ *
+ * The table is read once into a bitmap of used clusters.  Each chain is
+ * then followed and its clusters marked in a second bitmap, so a cluster
+ * reached twice is a cross-link and a used cluster never reached is lost.
+ * The bitmaps take clusterCount()/4 bytes of heap.  On a host card image
+ * the table is read by PFS_CHECK_THREADS threads.
+ *
+ * With repair a chain is cut before its first bad cluster, a chain longer
+ * than its file is cut to the file size, a size is cut to its chain and
+ * lost clusters are freed.  The entry found first keeps clusters shared
+ * by two chains.  No file on the volume may be open.
+ */
+class SdPfsCheck {
+ public:
+  SdPfsCheck() : vol_(0), used_(0), seen_(0) {
+    memset(&result_, 0, sizeof(result_));
+  }
+  ~SdPfsCheck() {clear();}
+  bool check(SdVolume* vol, bool repair = false);
+  /** \return The number of faults found by the last check(). */
+  uint32_t faults() const {
+    return result_.badChains + result_.crossLinks + result_.sizeErrors
+           + result_.lostChains + result_.freeCountBad;
+  }
+  /** \return Counts found by the last check(). */
+  const PfsCheck_t& result() const {return result_;}
+
+ private:
+  // fault found by walk()
+  static uint8_t const WALK_OK = 0;
+  static uint8_t const WALK_BAD = 1;
+  static uint8_t const WALK_CROSS = 2;
+  static uint8_t const WALK_LONG = 3;
+  SdVolume* vol_;
+  uint32_t* used_;      // one bit per cluster, set if the entry is not free
+  uint32_t* seen_;      // one bit per cluster, set if reached by a chain
+  bool repair_;         // fix the faults found
+  PfsCheck_t result_;
+
+  bool checkDir(uint32_t cluster, uint8_t depth, uint32_t* count,
+                uint8_t* fault);
+  bool checkEntry(uint32_t block, uint8_t index, uint8_t depth);
+  bool checkLost();
+  void clear();
+  void countFault(uint8_t fault);
+  static bool isSet(const uint32_t* map, uint32_t cluster) {
+    return map[cluster >> 5] & (1UL << (cluster & 31));
+  }
+  bool putEntry(uint32_t block, uint8_t index, const dir_t* d);
+  bool scanTable();
+  bool walk(uint32_t cluster, uint32_t keep, uint32_t* count,
+            bool* adjacent, uint8_t* fault);
+};
+#endif  // SdPfsCheck_h
@@ -1,152 +1,372 @@
-#ifndef SdPfsConfig_h
-#define SdPfsConfig_h
-#include <stdint.h>
-
-#ifdef __arm__
-#define USE_SEPARATE_PFS_CACHE 1
-#else  // __arm__ Arduino Uno es AVR asi que no usara otra cache!
-#define USE_SEPARATE_PFS_CACHE 0	
-#endif  // __arm__
-//------------------------------------------------------------------------------
-/**
- * Don't use mult-block read/write on small AVR boards
- */
-#if defined(RAMEND) && RAMEND < 3000
-#define USE_MULTI_BLOCK_SD_IO 0
-#else
-#define USE_MULTI_BLOCK_SD_IO 1
-#endif
-//------------------------------------------------------------------------------
-/**
- *  If set to 1 use just read methods for SD on Arduino, else check for USE_MEDIUM_API
- */
-#define USE_SMALL_API 1
- /**
- *  If set to 1 use just read+write methods for SD on Arduino, else FULL API is used
- */
-#define USE_MEDIUM_API 0
-/**
- *  Force use of Arduino Standard SPI library if USE_ARDUINO_SPI_LIBRARY
- * is nonzero.
- */
-#define USE_ARDUINO_SPI_LIBRARY 0
-//------------------------------------------------------------------------------
-/**
- * To enable SD card CRC checking set USE_SD_CRC nonzero.
- *
- * Set USE_SD_CRC to 1 to use a smaller slower CRC-CCITT function.
- *
- * Set USE_SD_CRC to 2 to used a larger faster table driven CRC-CCITT function.
- */
-#define USE_SD_CRC 0
-//------------------------------------------------------------------------------
-/**
- * Set DESTRUCTOR_CLOSES_FILE nonzero to close a file in its destructor.
- *
- * Causes use of lots of heap in ARM.
- */
-#define DESTRUCTOR_CLOSES_FILE 0
-//------------------------------------------------------------------------------
-/**
- * For AVR
- *
- * Set nonzero to use Serial (the HardwareSerial class) for error messages
- * and output from print functions like ls().
- *
- * If USE_SERIAL_FOR_STD_OUT is zero, a small non-interrupt driven class
- * is used to output messages to serial port zero.  This allows an alternate
- * Serial library like SerialPort to be used with SdFat.
- *
- * You can redirect stdOut with SdFat::setStdOut(Print* stream) and
- * get the current stream with SdFat::stdOut().
- */
-#define USE_SERIAL_FOR_STD_OUT 0
-//------------------------------------------------------------------------------
-/**
- * Call flush for endl if ENDL_CALLS_FLUSH is nonzero
- *
- * The standard for iostreams is to call flush.  This is very costly for
- * SdFat.  Each call to flush causes 2048 bytes of I/O to the SD.
- *
- * SdFat has a single 512 byte buffer for SD I/O so it must write the current
- * data block to the SD, read the directory block from the SD, update the
- * directory entry, write the directory block to the SD and read the data
- * block back into the buffer.
- *
- * The SD flash memory controller is not designed for this many rewrites
- * so performance may be reduced by more than a factor of 100.
- *
- * If ENDL_CALLS_FLUSH is zero, you must call flush and/or close to force
- * all data to be written to the SD.
- */
-#define ENDL_CALLS_FLUSH 0
-/**
- * SPI init rate for SD initialization commands. Must be 10 (F_CPU/64)
- * or greater
- */
-#define SPI_SD_INIT_RATE 11
- /**
- * Set USE_SOFTWARE_SPI nonzero to always use software SPI on AVR.
- */
-#define USE_SOFTWARE_SPI 0
- /**
- * Set USE_PFS_BITMAP nonzero to load to memory the bitmap region.
- * Not recommended on embeded arch.
- */
-#define USE_PFS_BITMAP 0
-
-#define ENABLED_READ_ONLY 0 //luego lo cambio, esto es solo para pruebas
-
-#define USING_APP 0
-
-// define software SPI pins so Mega can use unmodified 168/328 shields
-/** Default Software SPI chip select pin */
-uint8_t const SOFT_SPI_CS_PIN = 10;
-/** Software SPI Master Out Slave In pin */
-uint8_t const SOFT_SPI_MOSI_PIN = 11;
-/** Software SPI Master In Slave Out pin */
-uint8_t const SOFT_SPI_MISO_PIN = 12;
-/** Software SPI Clock pin */
-uint8_t const SOFT_SPI_SCK_PIN = 13;
-
-// values for type_
-/** This file has not been opened. */
-uint8_t const PFS_FILE_TYPE_CLOSED = 0;
-/** A normal file */
-uint8_t const PFS_FILE_TYPE_NORMAL = 1;
-/** A FAT12 or FAT16 root directory */
-uint8_t const PFS_FILE_TYPE_ROOT_FIXED = 2;
-/** A FAT32 root directory */
-uint8_t const PFS_FILE_TYPE_ROOT32 = 3;
-/** A subdirectory file*/
-uint8_t const PFS_FILE_TYPE_SUBDIR = 4;
-/** Test value for directory type */
-uint8_t const PFS_FILE_TYPE_MIN_DIR = PFS_FILE_TYPE_ROOT_FIXED;
-
-/** ls() flag to print file size */
-uint8_t const LS_SIZE = 2;
-/** ls() flag for recursive list of subdirectories */
-uint8_t const LS_R = 4;
-
-//open flags
-/** open() oflag for reading */
-uint8_t const O_READ = 0X01;
-/** open() oflag - same as O_IN */
-uint8_t const O_RDONLY = O_READ;
-/** open() oflag for write */
-uint8_t const O_WRITE = 0X02;
-/** open() oflag - same as O_WRITE */
-uint8_t const O_WRONLY = O_WRITE;
-/** open() oflag for reading and writing */
-uint8_t const O_RDWR = (O_READ | O_WRITE);
-/** open() oflag mask for access modes */
-uint8_t const O_ACCMODE = (O_READ | O_WRITE);
-/** create the file if nonexistent */
-uint8_t const O_CREAT = 0X40;
-
-//seek constants
-uint8_t const SEEK_BEG_ = 1;
-uint8_t const SEEK_CUR_ = 2;
-uint8_t const SEEK_END_ = 4;
-
+#ifndef SdPfsConfig_h
+#define SdPfsConfig_h
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+/**
+ * Set USE_HOST_SD_CARD nonzero to replace the SPI Sd2Card with a block
+ * device backed by an image file so the library can run, and be
+ * benchmarked, on a Linux host.  On by default outside the Arduino IDE.
+ */
+#ifdef ARDUINO
+#define USE_HOST_SD_CARD 0
+#else  // ARDUINO
+#define USE_HOST_SD_CARD 1
+#endif  // ARDUINO
+//------------------------------------------------------------------------------
+#ifdef __arm__
+#define USE_SEPARATE_PFS_CACHE 1
+#else  // __arm__ Arduino Uno es AVR asi que no usara otra cache!
+#define USE_SEPARATE_PFS_CACHE 0	
+#endif  // __arm__
+//------------------------------------------------------------------------------
+/**
+ * Size of the SdVolume block cache.
+ *
+ * CACHE_DATA_BLOCKS 512 byte buffers hold data and directory blocks.  If
+ * USE_SEPARATE_PFS_CACHE is nonzero, CACHE_PFS_BLOCKS more buffers hold
+ * only PFS table blocks, else table blocks share the data buffers.  The
+ * least recently used buffer is replaced.
+ *
+ * Small AVR boards only have room for one buffer.
+ */
+#if defined(RAMEND) && RAMEND < 3000
+#define CACHE_DATA_BLOCKS 1
+#else  // RAMEND
+#define CACHE_DATA_BLOCKS 4
+#endif  // RAMEND
+#define CACHE_PFS_BLOCKS 2
+//------------------------------------------------------------------------------
+/**
+ * Number of extents, runs of adjacent clusters, each SdBaseFile remembers.
+ *
+ * Extents are recorded as the cluster chain is followed by read, write and
+ * seek.  A seek into a recorded extent needs no PFS table reads, a seek
+ * past the last extent walks the chain from the end of that extent.  Each
+ * extent uses 12 bytes of RAM in every SdBaseFile.
+ */
+#if defined(RAMEND) && RAMEND < 3000
+#define EXTENT_CACHE_SIZE 2
+#else  // RAMEND
+#define EXTENT_CACHE_SIZE 8
+#endif  // RAMEND
+//------------------------------------------------------------------------------
+/**
+ * Number of slots in the SdVolume directory name hash, a power of two or
+ * zero to always search directories linearly.
+ *
+ * The hash maps names of the last directory searched by open() to their
+ * entry numbers so later opens in that directory read one entry.  It is
+ * built by the first search of a directory and holds at most 3/4 of
+ * DIR_HASH_SIZE names.  A larger directory is remembered as full and
+ * searched linearly without being hashed again.  remove() marks the slot
+ * of the name so its entry is used by the next create.  Each slot uses
+ * two bytes of RAM.
+ */
+#if USE_HOST_SD_CARD
+#define DIR_HASH_SIZE 8192
+#else  // USE_HOST_SD_CARD
+#define DIR_HASH_SIZE 0
+#endif  // USE_HOST_SD_CARD
+//------------------------------------------------------------------------------
+/**
+ * Don't use mult-block read/write on small AVR boards
+ */
+#if defined(RAMEND) && RAMEND < 3000
+#define USE_MULTI_BLOCK_SD_IO 0
+#else
+#define USE_MULTI_BLOCK_SD_IO 1
+#endif
+//------------------------------------------------------------------------------
+/**
+ * Entries in each of the two SdVolume PFS table windows, zero for none,
+ * else 16, 32 or 64.
+ *
+ * Without a separate table cache, following a cluster chain in read() or
+ * write() evicts the data block from the cache buffer.  pfsGet() reads
+ * table entries into a window with Sd2Card::readPart() instead.  Two
+ * windows let two files in different parts of the table be read without
+ * thrashing.  Only table changes use the cache buffer.  The windows use
+ * 8*PFS_WINDOW_ENTRIES bytes of RAM.
+ */
+#if defined(RAMEND) && RAMEND < 3000
+#define PFS_WINDOW_ENTRIES 32
+#else  // RAMEND
+#define PFS_WINDOW_ENTRIES 0
+#endif  // RAMEND
+//------------------------------------------------------------------------------
+/**
+ * Number of SdVolume read-ahead buffers, zero for no read-ahead.
+ *
+ * When a file is read sequentially in pieces smaller than a block, the
+ * blocks that follow are read into a ring of 512 byte buffers.  With
+ * ASYNC_SD_QUEUE the reads are queued on the card.  With ASYNC_SD_QUEUE
+ * zero they are read by one CMD18 that is kept open between calls and
+ * ended before any other card command.  The clusters of those blocks are
+ * looked up as they are queued, before the read reaches them.
+ */
+#if !USE_MULTI_BLOCK_SD_IO
+#define READ_AHEAD_BLOCKS 0
+#elif USE_HOST_SD_CARD
+#define READ_AHEAD_BLOCKS 8
+#else  // USE_MULTI_BLOCK_SD_IO
+#define READ_AHEAD_BLOCKS 4
+#endif  // USE_MULTI_BLOCK_SD_IO
+//------------------------------------------------------------------------------
+/**
+ * Number of Sd2Card asynchronous requests that may be outstanding, zero
+ * for no beginRead()/beginWrite() API.
+ *
+ * SdVolume uses the queue to write a full data block from the cache while
+ * the next block is filled in another buffer, and to fill the read-ahead
+ * ring while the caller works on data already read.  On the host the
+ * requests run on a worker thread, on AVR poll() moves them along.  With
+ * zero and READ_AHEAD_BLOCKS the ring is filled by a kept-open CMD18,
+ * which needs no poll() calls but blocks while each block is read.
+ */
+#if defined(RAMEND) && RAMEND < 3000
+#define ASYNC_SD_QUEUE 0
+#elif USE_HOST_SD_CARD
+#define ASYNC_SD_QUEUE 8
+#else  // RAMEND
+#define ASYNC_SD_QUEUE 2
+#endif  // RAMEND
+//------------------------------------------------------------------------------
+/**
+ * Bytes of the SdVolume map of table blocks whose mirror is out of date,
+ * zero to write the mirror with each table block.
+ *
+ * On a volume with two PFS tables and a PFS_info block, an evicted table
+ * block is written only to the first table and marked in the map.
+ * SdVolume::sync() copies the marked blocks to the mirror.  A marker in
+ * PFS_info makes init() repair the mirror if power was lost in between.
+ * Each bit covers a group of table blocks if the table has more than
+ * 8*PFS_MIRROR_MAP_SIZE blocks.
+ */
+#if defined(RAMEND) && RAMEND < 3000
+#define PFS_MIRROR_MAP_SIZE 0
+#elif USE_HOST_SD_CARD
+#define PFS_MIRROR_MAP_SIZE 1024
+#else  // RAMEND
+#define PFS_MIRROR_MAP_SIZE 32
+#endif  // RAMEND
+//------------------------------------------------------------------------------
+/**
+ * Set PFS_JOURNAL nonzero to use the metadata journal of volumes that have
+ * one, PFS_boot journalBlocks nonzero.
+ *
+ * Changes to PFS table and directory blocks are logged in the cache buffer
+ * that holds them.  SdVolume::sync() writes the changed data blocks, then
+ * appends the logged bytes to the journal as one transaction, so a sync
+ * usually costs one journal block.  Table and directory blocks are written
+ * in place when they leave the cache or the journal fills.  init() replays
+ * the journal, so a volume is as of the last sync after a power loss.
+ * A transaction larger than the journal on the card, which can only
+ * happen if it is smaller than JOURNAL_MAX_BLOCKS of this build, is
+ * written in place without that protection.
+ * Uses 512 bytes of RAM.  A volume with a journal can't be mounted without
+ * it.
+ */
+#if defined(RAMEND) && RAMEND < 3000
+#define PFS_JOURNAL 0
+#else  // RAMEND
+#define PFS_JOURNAL 1
+#endif  // RAMEND
+//------------------------------------------------------------------------------
+/**
+ * Number of runs of freed clusters SdVolume::eraseOnFree() queues between
+ * syncs, zero to not build eraseOnFree().
+ *
+ * When it is turned on, the clusters freed by SdBaseFile::truncate() and
+ * remove() are erased in runs of adjacent clusters, so a later write of
+ * the space finds pre-erased flash.  The runs are erased by the next
+ * sync() after the free is committed, runs past this number and runs
+ * allocated again before the sync are not erased.  Cards without single
+ * block erase only erase whole erase sectors of a run.  Each run uses
+ * eight bytes of RAM.
+ */
+#if defined(RAMEND) && RAMEND < 3000
+#define ERASE_FREED_CLUSTERS 0
+#elif USE_HOST_SD_CARD
+#define ERASE_FREED_CLUSTERS 16
+#else  // RAMEND
+#define ERASE_FREED_CLUSTERS 4
+#endif  // RAMEND
+//------------------------------------------------------------------------------
+/**
+ *  If set to 1 use just read methods for SD on Arduino, else check for USE_MEDIUM_API
+ */
+#define USE_SMALL_API 1
+ /**
+ *  If set to 1 use just read+write methods for SD on Arduino, else FULL API is used
+ */
+#define USE_MEDIUM_API 0
+/**
+ *  Force use of Arduino Standard SPI library if USE_ARDUINO_SPI_LIBRARY
+ * is nonzero.
+ */
+#define USE_ARDUINO_SPI_LIBRARY 0
+/**
+ * Set USE_CUSTOM_SPI nonzero to use SPI transfer functions supplied by the
+ * application, for example a DMA driver.  See Sd2Card.h for the functions.
+ * The host card does not use SPI, it moves blocks with pread()/pwrite()
+ * and charges SdHostLatency::blockNanos for the transfer.
+ */
+#define USE_CUSTOM_SPI 0
+//------------------------------------------------------------------------------
+/**
+ * To enable SD card CRC checking set USE_SD_CRC nonzero.
+ *
+ * Set USE_SD_CRC to 1 to use a smaller slower CRC-CCITT function.
+ *
+ * Set USE_SD_CRC to 2 to used a larger faster table driven CRC-CCITT function.
+ * The tables use 768 bytes of flash on AVR and 2304 bytes elsewhere.
+ */
+#define USE_SD_CRC 0
+/**
+ * Set SD_CRC_READ_ONLY nonzero to only check the CRC of data read when
+ * USE_SD_CRC is nonzero.  The card always sends a CRC with read data, so
+ * CRC checking is not turned on in the card and commands and written
+ * blocks are sent without a CRC.
+ */
+#define SD_CRC_READ_ONLY 0
+//------------------------------------------------------------------------------
+/**
+ * Set DESTRUCTOR_CLOSES_FILE nonzero to close a file in its destructor.
+ *
+ * Causes use of lots of heap in ARM.
+ */
+#define DESTRUCTOR_CLOSES_FILE 0
+//------------------------------------------------------------------------------
+/**
+ * For AVR
+ *
+ * Set nonzero to use Serial (the HardwareSerial class) for error messages
+ * and output from print functions like ls().
+ *
+ * If USE_SERIAL_FOR_STD_OUT is zero, a small non-interrupt driven class
+ * is used to output messages to serial port zero.  This allows an alternate
+ * Serial library like SerialPort to be used with SdFat.
+ *
+ * You can redirect stdOut with SdFat::setStdOut(Print* stream) and
+ * get the current stream with SdFat::stdOut().
+ */
+#define USE_SERIAL_FOR_STD_OUT 0
+//------------------------------------------------------------------------------
+/**
+ * Call flush for endl if ENDL_CALLS_FLUSH is nonzero
+ *
+ * The standard for iostreams is to call flush.  This is very costly for
+ * SdFat.  Each call to flush causes 2048 bytes of I/O to the SD.
+ *
+ * SdFat has a single 512 byte buffer for SD I/O so it must write the current
+ * data block to the SD, read the directory block from the SD, update the
+ * directory entry, write the directory block to the SD and read the data
+ * block back into the buffer.
+ *
+ * The SD flash memory controller is not designed for this many rewrites
+ * so performance may be reduced by more than a factor of 100.
+ *
+ * If ENDL_CALLS_FLUSH is zero, you must call flush and/or close to force
+ * all data to be written to the SD.
+ */
+#define ENDL_CALLS_FLUSH 0
+//------------------------------------------------------------------------------
+/**
+ * SdBaseFile::write() leaves the directory entry and the cache dirty
+ * until one of these limits is reached, sync() is called or the file is
+ * closed.  A file opened with O_SYNC is synced by every write() call.
+ *
+ * WRITE_SYNC_BYTES - bytes written since the last sync, zero for no limit.
+ *
+ * WRITE_SYNC_MILLIS - ms since the first write after the last sync, zero
+ * for no limit.  The limit is only checked by write().
+ */
+#define WRITE_SYNC_BYTES 16384
+#define WRITE_SYNC_MILLIS 1000
+/**
+ * SPI init rate for SD initialization commands. Must be 10 (F_CPU/64)
+ * or greater
+ */
+#define SPI_SD_INIT_RATE 11
+ /**
+ * Set USE_SOFTWARE_SPI nonzero to always use software SPI on AVR.
+ */
+#define USE_SOFTWARE_SPI 0
+ /**
+ * Set USE_PFS_BITMAP nonzero to load to memory the bitmap region.
+ * Not recommended on embeded arch.
+ *
+ * SdVolume::init() builds a bitmap with one bit per cluster from the PFS
+ * table, allocation then searches it a word at a time.  The bitmap is
+ * allocated with malloc(), 128 KB for a million clusters.
+ */
+#if USE_HOST_SD_CARD
+#define USE_PFS_BITMAP 1
+#else  // USE_HOST_SD_CARD
+#define USE_PFS_BITMAP 0
+#endif  // USE_HOST_SD_CARD
+ /**
+ * Number of threads SdPfsCheck uses to read the PFS table of a host card
+ * image, zero for one per processor.  Each thread reads at least 64 table
+ * blocks so a small table is read by the calling thread.
+ */
+#define PFS_CHECK_THREADS 0
+
+#define ENABLED_READ_ONLY 0 //luego lo cambio, esto es solo para pruebas
+
+#define USING_APP 0
+
+// define software SPI pins so Mega can use unmodified 168/328 shields
+/** Default Software SPI chip select pin */
+uint8_t const SOFT_SPI_CS_PIN = 10;
+/** Software SPI Master Out Slave In pin */
+uint8_t const SOFT_SPI_MOSI_PIN = 11;
+/** Software SPI Master In Slave Out pin */
+uint8_t const SOFT_SPI_MISO_PIN = 12;
+/** Software SPI Clock pin */
+uint8_t const SOFT_SPI_SCK_PIN = 13;
+
+// values for type_
+/** This file has not been opened. */
+uint8_t const PFS_FILE_TYPE_CLOSED = 0;
+/** A normal file */
+uint8_t const PFS_FILE_TYPE_NORMAL = 1;
+/** A FAT12 or FAT16 root directory */
+uint8_t const PFS_FILE_TYPE_ROOT_FIXED = 2;
+/** A FAT32 root directory */
+uint8_t const PFS_FILE_TYPE_ROOT32 = 3;
+/** A subdirectory file*/
+uint8_t const PFS_FILE_TYPE_SUBDIR = 4;
+/** Test value for directory type */
+uint8_t const PFS_FILE_TYPE_MIN_DIR = PFS_FILE_TYPE_ROOT_FIXED;
+
+/** ls() flag to print file size */
+uint8_t const LS_SIZE = 2;
+/** ls() flag for recursive list of subdirectories */
+uint8_t const LS_R = 4;
+
+//open flags
+/** open() oflag for reading */
+uint8_t const O_READ = 0X01;
+/** open() oflag - same as O_IN */
+uint8_t const O_RDONLY = O_READ;
+/** open() oflag for write */
+uint8_t const O_WRITE = 0X02;
+/** open() oflag - same as O_WRITE */
+uint8_t const O_WRONLY = O_WRITE;
+/** open() oflag for reading and writing */
+uint8_t const O_RDWR = (O_READ | O_WRITE);
+/** open() oflag mask for access modes */
+uint8_t const O_ACCMODE = (O_READ | O_WRITE);
+/** sync the file on every write() call */
+uint8_t const O_SYNC = 0X08;
+/** create the file if nonexistent */
+uint8_t const O_CREAT = 0X40;
+
+//seek constants
+uint8_t const SEEK_BEG_ = 1;
+uint8_t const SEEK_CUR_ = 2;
+uint8_t const SEEK_END_ = 4;
+
 #endif  //SdPfsConfig_h
\ No newline at end of file
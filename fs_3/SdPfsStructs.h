@@ -1,183 +1,230 @@
-/* Arduino PFS Library
- * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
- *
- * This file is part of the Arduino PFS Library
- *
- * This Library is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This Library is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with the Arduino PFS Library.  If not, see
- * <http://www.gnu.org/licenses/>.
- */
-/*
- *Creditos: https://github.com/frasermac/sdfatlib
- */
-#ifndef SdPfsStructs_h
-#define SdPfsStructs_h
-#include <stdint.h>
-
-struct partitionTable {
-  uint8_t  boot;
-  uint8_t  beginHead;
-  unsigned beginSector : 6;
-  unsigned beginCylinderHigh : 2;
-  uint8_t  beginCylinderLow;
-  uint8_t  type;
-  uint8_t  endHead;
-  unsigned endSector : 6;
-  unsigned endCylinderHigh : 2;
-  uint8_t  endCylinderLow;
-  uint32_t firstSector;
-  uint32_t totalSectors;
-}__attribute__((packed));
-/** Type name for partitionTable */
-typedef struct partitionTable part_t;
-//------------------------------------------------------------------------------
-struct masterBootRecord {
-  uint8_t  codeArea[446];
-           /** Partition tables. */
-  part_t   part[4];
-           /** First MBR signature byte. Must be 0X55 */
-  uint8_t  mbrSig0;
-           /** Second MBR signature byte. Must be 0XAA */
-  uint8_t  mbrSig1;
-}__attribute__((packed));
-/** Type name for masterBootRecord */
-typedef struct masterBootRecord mbr_t;
-
-
-struct directoryEntry {
-  uint8_t  name[11];   
-          /** Entry attributes.
-           *
-           * The upper two bits of the attribute byte are reserved and should
-           * always be set to 0 when a file is created and never modified or
-           * looked at after that.  See defines that begin with DIR_ATT_.
-           */
-  uint8_t  attributes;
-  uint32_t fileSize;
-  uint32_t firstCluster;
-
-  uint8_t  padding[12];
-}__attribute__((packed));
-
-typedef struct directoryEntry dir_t;
-//------------------------------------------------------------------------------
-
-struct PFS_boot{  
-  uint16_t bytesPerSector;
-  uint8_t  sectorsPerCluster;
-  uint32_t totalSectors;
-  uint32_t pfsRootCluster;
-  uint16_t rootDirEntryCount;
-  char     volumeLabel[11];
-  char     fileSystemType[8];
-  uint16_t pfsInfo;  
-  uint8_t  bootSectorSig0;
-  uint8_t  bootSectorSig1;
-  uint16_t sectorsPerFat;
-  
-  uint8_t  padding[512-38];
-}__attribute__((packed));
-
-typedef struct PFS_boot pfs_boot_t;
-
-struct PFS_info{
-  uint32_t  leadSignature;
-  uint8_t   reserved1[480];
-  uint32_t  structSignature;
-  uint32_t  freeCount;
-  uint32_t  nextFree;
-  uint8_t   reserved2[12];
-  uint8_t   tailSignature[4];
-}__attribute__((packed));
-
-typedef struct PFS_info pfs_info_t;
-//------------------------------------------------------------------------------
-
-uint32_t const PFSEOC_MIN = 0X0FFFFFF8;
-uint32_t const PFSMASK = 0X0FFFFFFF;
-
-/** Value for byte 510 of boot block or MBR */
-uint8_t const BOOTSIG0 = 0X55;
-/** Value for byte 511 of boot block or MBR */
-uint8_t const BOOTSIG1 = 0XAA;
-/** Value for bootSignature field int FAT/FAT32 boot sector */
-uint8_t const EXTENDED_BOOT_SIG = 0X29;
-
-/** Lead signature for a FSINFO sector */
-uint32_t const FSINFO_LEAD_SIG = 0x41615252;
-/** Struct signature for a FSINFO sector */
-uint32_t const FSINFO_STRUCT_SIG = 0x61417272;
-
-// Definitions for directory entries
-
-/** escape for name[0] = 0XE5 */
-uint8_t const DIR_NAME_0XE5 = 0X05;
-/** name[0] value for entry that is free after being "deleted" */
-uint8_t const DIR_NAME_DELETED = 0XE5;
-/** name[0] value for entry that is free and no allocated entries follow */
-uint8_t const DIR_NAME_FREE = 0X00;
-/** file is read-only */
-uint8_t const DIR_ATT_READ_ONLY = 0X01;
-/** File should hidden in directory listings */
-uint8_t const DIR_ATT_HIDDEN = 0X02;
-/** Entry is for a system file */
-uint8_t const DIR_ATT_SYSTEM = 0X04;
-/** Directory entry contains the volume label */
-uint8_t const DIR_ATT_VOLUME_ID = 0X08;
-/** Entry is for a directory */
-uint8_t const DIR_ATT_DIRECTORY = 0X10;
-/** Old DOS archive bit for backup support */
-uint8_t const DIR_ATT_ARCHIVE = 0X20;
-/** Test value for long name entry.  Test is
-  (d->attributes & DIR_ATT_LONG_NAME_MASK) == DIR_ATT_LONG_NAME. */
-uint8_t const DIR_ATT_LONG_NAME = 0X0F;
-/** Test mask for long name entry */
-uint8_t const DIR_ATT_LONG_NAME_MASK = 0X3F;
-/** defined attribute bits */
-uint8_t const DIR_ATT_DEFINED_BITS = 0X3F;
-/** Directory entry is part of a long name
- * \param[in] dir Pointer to a directory entry.
- *
- * \return true if the entry is for part of a long name else false.
- */
-static inline uint8_t DIR_IS_LONG_NAME(const dir_t* dir) {
-  return (dir->attributes & DIR_ATT_LONG_NAME_MASK) == DIR_ATT_LONG_NAME;
-}
-/** Mask for file/subdirectory tests */
-uint8_t const DIR_ATT_FILE_TYPE_MASK = (DIR_ATT_VOLUME_ID | DIR_ATT_DIRECTORY);
-/** Directory entry is for a file
- * \param[in] dir Pointer to a directory entry.
- *
- * \return true if the entry is for a normal file else false.
- */
-static inline uint8_t DIR_IS_FILE(const dir_t* dir) {
-  return (dir->attributes & DIR_ATT_FILE_TYPE_MASK) == 0;
-}
-/** Directory entry is for a subdirectory
- * \param[in] dir Pointer to a directory entry.
- *
- * \return true if the entry is for a subdirectory else false.
- */
-static inline uint8_t DIR_IS_SUBDIR(const dir_t* dir) {
-  return (dir->attributes & DIR_ATT_FILE_TYPE_MASK) == DIR_ATT_DIRECTORY;
-}
-/** Directory entry is for a file or subdirectory
- * \param[in] dir Pointer to a directory entry.
- *
- * \return true if the entry is for a normal file or subdirectory else false.
- */
-static inline uint8_t DIR_IS_FILE_OR_SUBDIR(const dir_t* dir) {
-  return (dir->attributes & DIR_ATT_VOLUME_ID) == 0;
-}
-
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ *Creditos: https://github.com/frasermac/sdfatlib
+ */
+#ifndef SdPfsStructs_h
+#define SdPfsStructs_h
+#include <stdint.h>
+
+struct partitionTable {
+  uint8_t  boot;
+  uint8_t  beginHead;
+  unsigned beginSector : 6;
+  unsigned beginCylinderHigh : 2;
+  uint8_t  beginCylinderLow;
+  uint8_t  type;
+  uint8_t  endHead;
+  unsigned endSector : 6;
+  unsigned endCylinderHigh : 2;
+  uint8_t  endCylinderLow;
+  uint32_t firstSector;
+  uint32_t totalSectors;
+}__attribute__((packed));
+/** Type name for partitionTable */
+typedef struct partitionTable part_t;
+//------------------------------------------------------------------------------
+struct masterBootRecord {
+  uint8_t  codeArea[446];
+           /** Partition tables. */
+  part_t   part[4];
+           /** First MBR signature byte. Must be 0X55 */
+  uint8_t  mbrSig0;
+           /** Second MBR signature byte. Must be 0XAA */
+  uint8_t  mbrSig1;
+}__attribute__((packed));
+/** Type name for masterBootRecord */
+typedef struct masterBootRecord mbr_t;
+
+
+struct directoryEntry {
+  uint8_t  name[11];   
+          /** Entry attributes.
+           *
+           * The upper two bits of the attribute byte are reserved and should
+           * always be set to 0 when a file is created and never modified or
+           * looked at after that.  See defines that begin with DIR_ATT_.
+           */
+  uint8_t  attributes;
+  uint32_t fileSize;
+  uint32_t firstCluster;
+          /** PFS flags, see defines that begin with DIR_PFS_. */
+  uint8_t  pfsFlags;
+          /** Clusters in a directory or allocated to a DIR_PFS_CONTIGUOUS
+           *  file, zero if not known. */
+  uint32_t clusterCount;
+
+  uint8_t  padding[7];
+}__attribute__((packed));
+
+typedef struct directoryEntry dir_t;
+//------------------------------------------------------------------------------
+
+struct PFS_boot{  
+  uint16_t bytesPerSector;
+  uint8_t  sectorsPerCluster;
+  uint32_t totalSectors;
+  uint32_t pfsRootCluster;
+  uint16_t rootDirEntryCount;
+  char     volumeLabel[11];
+  char     fileSystemType[8];
+  uint16_t pfsInfo;  
+  uint8_t  bootSectorSig0;
+  uint8_t  bootSectorSig1;
+  uint16_t sectorsPerFat;
+          /** Number of copies of the PFS table, zero is read as one. */
+  uint8_t  pfsCount;
+          /** Blocks of the metadata journal before the data, zero if none. */
+  uint16_t journalBlocks;
+
+  uint8_t  padding[512-41];
+}__attribute__((packed));
+
+typedef struct PFS_boot pfs_boot_t;
+
+struct PFS_info{
+  uint32_t  leadSignature;
+  uint8_t   reserved1[480];
+  uint32_t  structSignature;
+  uint32_t  freeCount;
+  uint32_t  nextFree;
+          /** PFS_MIRROR_STALE if the second table may be out of date. */
+  uint32_t  mirrorState;
+  uint8_t   reserved2[8];
+  uint8_t   tailSignature[4];
+}__attribute__((packed));
+
+typedef struct PFS_info pfs_info_t;
+
+struct PFS_journal{
+          /** PFS_JOURNAL_SIG */
+  uint32_t  signature;
+          /** One more than the sequence of the transaction before it. */
+  uint32_t  sequence;
+          /** Journal blocks of the transaction, this one included. */
+  uint16_t  blockCount;
+          /** CRC-CCITT of the bytes that follow the header. */
+  uint16_t  checksum;
+          /** Bytes of the transaction, this header included. */
+  uint32_t  byteCount;
+          /** Free cluster count after the transaction, 0XFFFFFFFF if unknown. */
+  uint32_t  freeCount;
+          /** Cluster to start the search for a free cluster. */
+  uint32_t  nextFree;
+}__attribute__((packed));
+
+typedef struct PFS_journal pfs_journal_t;
+
+// The header is followed by records, each a pfs_journal_record_t and count
+// bytes to copy to block at offset.  Records continue into the following
+// blocks of the transaction.
+struct PFS_journal_record{
+  uint32_t  block;
+  uint16_t  offset;
+  uint16_t  count;
+}__attribute__((packed));
+
+typedef struct PFS_journal_record pfs_journal_record_t;
+//------------------------------------------------------------------------------
+
+uint32_t const PFSEOC_MIN = 0X0FFFFFF8;
+uint32_t const PFSMASK = 0X0FFFFFFF;
+
+/** Value for byte 510 of boot block or MBR */
+uint8_t const BOOTSIG0 = 0X55;
+/** Value for byte 511 of boot block or MBR */
+uint8_t const BOOTSIG1 = 0XAA;
+/** Value for bootSignature field int FAT/FAT32 boot sector */
+uint8_t const EXTENDED_BOOT_SIG = 0X29;
+
+/** Lead signature for a FSINFO sector */
+uint32_t const FSINFO_LEAD_SIG = 0x41615252;
+/** Struct signature for a FSINFO sector */
+uint32_t const FSINFO_STRUCT_SIG = 0x61417272;
+/** mirrorState of a PFS_info sector written before the mirror is updated */
+uint32_t const PFS_MIRROR_STALE = 0x4D495252;
+/** signature of a transaction in the metadata journal */
+uint32_t const PFS_JOURNAL_SIG = 0x4C4E524A;
+
+// Definitions for directory entries
+
+/** escape for name[0] = 0XE5 */
+uint8_t const DIR_NAME_0XE5 = 0X05;
+/** name[0] value for entry that is free after being "deleted" */
+uint8_t const DIR_NAME_DELETED = 0XE5;
+/** name[0] value for entry that is free and no allocated entries follow */
+uint8_t const DIR_NAME_FREE = 0X00;
+/** file is read-only */
+uint8_t const DIR_ATT_READ_ONLY = 0X01;
+/** File should hidden in directory listings */
+uint8_t const DIR_ATT_HIDDEN = 0X02;
+/** Entry is for a system file */
+uint8_t const DIR_ATT_SYSTEM = 0X04;
+/** Directory entry contains the volume label */
+uint8_t const DIR_ATT_VOLUME_ID = 0X08;
+/** Entry is for a directory */
+uint8_t const DIR_ATT_DIRECTORY = 0X10;
+/** Old DOS archive bit for backup support */
+uint8_t const DIR_ATT_ARCHIVE = 0X20;
+/** Test value for long name entry.  Test is
+  (d->attributes & DIR_ATT_LONG_NAME_MASK) == DIR_ATT_LONG_NAME. */
+uint8_t const DIR_ATT_LONG_NAME = 0X0F;
+/** Test mask for long name entry */
+uint8_t const DIR_ATT_LONG_NAME_MASK = 0X3F;
+/** defined attribute bits */
+uint8_t const DIR_ATT_DEFINED_BITS = 0X3F;
+/** file clusters are one run of adjacent clusters */
+uint8_t const DIR_PFS_CONTIGUOUS = 0X01;
+/** Directory entry is part of a long name
+ * \param[in] dir Pointer to a directory entry.
+ *
+ * \return true if the entry is for part of a long name else false.
+ */
+static inline uint8_t DIR_IS_LONG_NAME(const dir_t* dir) {
+  return (dir->attributes & DIR_ATT_LONG_NAME_MASK) == DIR_ATT_LONG_NAME;
+}
+/** Mask for file/subdirectory tests */
+uint8_t const DIR_ATT_FILE_TYPE_MASK = (DIR_ATT_VOLUME_ID | DIR_ATT_DIRECTORY);
+/** Directory entry is for a file
+ * \param[in] dir Pointer to a directory entry.
+ *
+ * \return true if the entry is for a normal file else false.
+ */
+static inline uint8_t DIR_IS_FILE(const dir_t* dir) {
+  return (dir->attributes & DIR_ATT_FILE_TYPE_MASK) == 0;
+}
+/** Directory entry is for a subdirectory
+ * \param[in] dir Pointer to a directory entry.
+ *
+ * \return true if the entry is for a subdirectory else false.
+ */
+static inline uint8_t DIR_IS_SUBDIR(const dir_t* dir) {
+  return (dir->attributes & DIR_ATT_FILE_TYPE_MASK) == DIR_ATT_DIRECTORY;
+}
+/** Directory entry is for a file or subdirectory
+ * \param[in] dir Pointer to a directory entry.
+ *
+ * \return true if the entry is for a normal file or subdirectory else false.
+ */
+static inline uint8_t DIR_IS_FILE_OR_SUBDIR(const dir_t* dir) {
+  return (dir->attributes & DIR_ATT_VOLUME_ID) == 0;
+}
+
 #endif  //SdPfsStructs_h
\ No newline at end of file
@@ -1,445 +1,1803 @@
-#include <SdVolume.h>
-// macro for debug
-#define DBG_FAIL_MACRO  //  Serial.print(__FILE__);Serial.println(__LINE__)
-
-cache_t  SdVolume::cacheBuffer_;       // 512 byte cache for Sd2Card
-uint32_t SdVolume::cacheBlockNumber_;  // current block number
-uint8_t  SdVolume::cacheStatus_;       // status of cache block
-uint32_t SdVolume::cachePfsOffset_;    // offset for mirrored PFS
-#if USE_SEPARATE_PFS_CACHE
-cache_t  SdVolume::cachePfsBuffer_;       // 512 byte cache for FAT
-uint32_t SdVolume::cachePfsBlockNumber_;  // current Fat block number
-uint8_t  SdVolume::cachePfsStatus_;       // status of cache Fatblock
-#endif  // USE_SEPARATE_FAT_CACHE
-Sd2Card* SdVolume::sdCard_;            // pointer to SD card object
-//------------------------------
-
-bool SdVolume::pfsGet(uint32_t cluster, uint32_t* value) {
-  uint32_t lba;
-  cache_t* pc;
-  // error if reserved cluster of beyond FAT
-  if (cluster < 2  || cluster > (clusterCount_ + 1)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  lba = pfsStartBlock_ + (cluster >> 7);
-  pc = cacheFetchPfs(lba, CACHE_FOR_READ);
-  if (!pc) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  *value = pc->fat32[cluster & 0X7F] & PFSMASK;
-  
-  return true;
-
- fail:
-  return false;
-}
-
-bool SdVolume::pfsPut(uint32_t cluster, uint32_t value) {
-  #if ENABLED_READ_ONLY
-  return true;
-  #else
-  uint32_t lba;
-  cache_t* pc;
-  if (cluster < 2 || cluster > (clusterCount_ + 1)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  lba = pfsStartBlock_ + (cluster >> 7);
-
-  pc = cacheFetchPfs(lba, CACHE_FOR_WRITE);
-  if (!pc) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  pc->fat32[cluster & 0X7F] = value;
-  
-  return true;
-
- fail:
-  return false;
-  #endif  //ENABLED_READ_ONLY
-}
-
-bool SdVolume::allocContiguous(uint32_t count, uint32_t* curCluster) {
-  // start of group
-  uint32_t bgnCluster;
-  // end of group
-  uint32_t endCluster;
-  // last cluster of FAT
-  uint32_t fatEnd = clusterCount_ + 1;
-
-  // flag to save place to start next search
-  bool setStart;
-
-  // set search start cluster
-  if (*curCluster) {
-    // try to make file contiguous
-    bgnCluster = *curCluster + 1;
-
-    // don't save new start location
-    setStart = false;
-  } else {
-    // start at likely place for free cluster
-    bgnCluster = allocSearchStart_;
-
-    // save next search start if one cluster
-    setStart = count == 1;
-  }
-  // end of group
-  endCluster = bgnCluster;
-
-  // search the FAT for free clusters
-  for (uint32_t n = 0;; n++, endCluster++) {
-    // can't find space checked all clusters
-    if (n >= clusterCount_) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    // past end - start from beginning of FAT
-    if (endCluster > fatEnd) {
-      bgnCluster = endCluster = 2;
-    }
-    uint32_t f;
-    if (!pfsGet(endCluster, &f)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-
-    if (f != 0) {
-      // cluster in use try next cluster as bgnCluster
-      bgnCluster = endCluster + 1;
-    } else if ((endCluster - bgnCluster + 1) == count) {
-      // done - found space
-      break;
-    }
-  }
-  // mark end of chain
-  if (!pfsPutEOC(endCluster)) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  // link clusters
-  while (endCluster > bgnCluster) {
-    if (!pfsPut(endCluster - 1, endCluster)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    endCluster--;
-  }
-  if (*curCluster != 0) {
-    // connect chains
-    if (!pfsPut(*curCluster, bgnCluster)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-  }
-  // return first cluster number to caller
-  *curCluster = bgnCluster;
-
-  // remember possible next free cluster
-  if (setStart) allocSearchStart_ = bgnCluster + 1;
-
-  return true;
-
- fail:
-  return false;
-}
-
-uint32_t SdVolume::clusterStartBlock(uint32_t cluster) const {
-  return dataStartBlock_ + ((cluster - 2)*blocksPerCluster_);
-}
-
-// free a cluster chain
-bool SdVolume::freeChain(uint32_t cluster) {
-  #if ENABLED_READ_ONLY
-  return true;
-  #else
-  uint32_t next;
-
-  // clear free cluster location
-  allocSearchStart_ = 2;
-
-  do {
-    if (!pfsGet(cluster, &next)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    // free cluster
-    if (!pfsPut(cluster, 0)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-
-    cluster = next;
-  } while (!isEOC(cluster));
-
-  return true;
-
- fail:
-  return false;
-  #endif
-}
-
-int32_t SdVolume::freeClusterCount() {
-  uint32_t free = 0;
-  uint32_t lba;
-  uint32_t todo = clusterCount_ + 2;
-  uint16_t n;
-
-  lba = pfsStartBlock_;
-  while (todo) {
-    cache_t* pc = cacheFetchPfs(lba++, CACHE_FOR_READ);
-    if (!pc) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    n = 128;
-    if (todo < n) n = todo;
-    for (uint16_t i = 0; i < n; i++) {
-      if (pc->fat32[i] == 0) free++;
-    }    
-    todo -= n;
-  }
-  return free;
-
- fail:
-  return -1;
-}
-
-#if !USE_SEPARATE_PFS_CACHE
-
-cache_t* SdVolume::cacheFetchPfs(uint32_t blockNumber, uint8_t options) {
-  return cacheFetch(blockNumber, options | CACHE_STATUS_PFS_BLOCK);
-}
-
-cache_t* SdVolume::cacheFetch(uint32_t blockNumber, uint8_t options) {
-  if (cacheBlockNumber_ != blockNumber) {
-    if (!cacheSync()) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if (!(options & CACHE_OPTION_NO_READ)) {
-      if (!sdCard_->readBlock(blockNumber, cacheBuffer_.data)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    cacheStatus_ = 0;
-    cacheBlockNumber_ = blockNumber;
-  }
-  cacheStatus_ |= options & CACHE_STATUS_MASK;
-  return &cacheBuffer_;
-
- fail:
-  return 0;
-}
-
-bool SdVolume::cacheSync() {
-  #if ENABLED_READ_ONLY
-  return true;
-  #else
-  if (cacheStatus_ & CACHE_STATUS_DIRTY) {
-    if (!sdCard_->writeBlock(cacheBlockNumber_, cacheBuffer_.data)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    cacheStatus_ &= ~CACHE_STATUS_DIRTY;
-  }
-  return true;
-
- fail:
-  return false;
- #endif  // ENABLED_READ_ONLY
-}
-
-bool SdVolume::cacheWriteData() {
-  return cacheSync();
-}
-
-#else
-
-cache_t* SdVolume::cacheFetch(uint32_t blockNumber, uint8_t options) {
-  return cacheFetchData(blockNumber, options);
-}
-
-cache_t* SdVolume::cacheFetchData(uint32_t blockNumber, uint8_t options) {
-  if (cacheBlockNumber_ != blockNumber) {
-    if (!cacheWriteData()) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if (!(options & CACHE_OPTION_NO_READ)) {
-      if (!sdCard_->readBlock(blockNumber, cacheBuffer_.data)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    cacheStatus_ = 0;
-    cacheBlockNumber_ = blockNumber;
-  }
-  cacheStatus_ |= options & CACHE_STATUS_MASK;
-  return &cacheBuffer_;
-
- fail:
-  return 0;
-}
-
-cache_t* SdVolume::cacheFetchPfs(uint32_t blockNumber, uint8_t options) {
-  if (cachePfsBlockNumber_ != blockNumber) {
-    if (!cacheWritePfs()) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    if (!(options & CACHE_OPTION_NO_READ)) {
-      if (!sdCard_->readBlock(blockNumber, cachePfsBuffer_.data)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    cachePfsStatus_ = 0;
-    cachePfsBlockNumber_ = blockNumber;
-  }
-  cachePfsStatus_ |= options & CACHE_STATUS_MASK;
-  return &cachePfsBuffer_;
-
- fail:
-  return 0;
-}
-
-bool SdVolume::cacheWriteData() {
-  #if ENABLED_READ_ONLY
-  return true;
-  #else
-  if (cacheStatus_ & CACHE_STATUS_DIRTY) {
-    if (!sdCard_->writeBlock(cacheBlockNumber_, cacheBuffer_.data)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    cacheStatus_ &= ~CACHE_STATUS_DIRTY;
-  }
-  return true;
-
- fail:
-  return false;
-  #endif  //ENABLED_READ_ONLY
-}
-
-bool SdVolume::cacheWritePfs() {
-  #if ENABLED_READ_ONLY
-  return true;
-  #else
-  if (cachePfsStatus_ & CACHE_STATUS_DIRTY) {
-    if (!sdCard_->writeBlock(cachePfsBlockNumber_, cachePfsBuffer_.data)) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    // mirror second FAT
-    if (cachePfsOffset_) {
-      uint32_t lbn = cachePfsBlockNumber_ + cachePfsOffset_;
-      if (!sdCard_->writeBlock(lbn, cachePfsBuffer_.data)) {
-        DBG_FAIL_MACRO;
-        goto fail;
-      }
-    }
-    cachePfsStatus_ &= ~CACHE_STATUS_DIRTY;
-  }
-  return true;
-
- fail:
-  return false;
-  #endif  // ENABLED_READ_ONLY
-}
-
-bool SdVolume::cacheSync() {
-  return cacheWriteData() && cacheWritePfs();
-}
-
-#endif // USE_SEPARATE_PFS_CACHE
-
-void SdVolume::cacheInvalidate() {
-  #if !ENABLED_READ_ONLY
-    cacheBlockNumber_ = 0XFFFFFFFF;
-    cacheStatus_ = 0;
-  #endif
-}
-
-bool SdVolume::init(Sd2Card* dev, uint8_t part) {
-  uint32_t totalBlocks;
-  uint32_t volumeStartBlock = 0;
-  pfs_boot_t* pbs;
-  cache_t* pc;
-  sdCard_ = dev;
-  allocSearchStart_ = 2;
-  cacheStatus_ = 0; 
-  cacheBlockNumber_ = 0XFFFFFFFF;
-#if USE_SEPARATE_PFS_CACHE
-  cachePfsStatus_ = 0;  
-  cachePfsBlockNumber_ = 0XFFFFFFFF;
-#endif  // USE_SEPARATE_PFS_CACHE
-  if (part) {
-    if (part > 4) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    pc = cacheFetch(volumeStartBlock, CACHE_FOR_READ);
-    if (!pc) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    part_t* p = &pc->mbr.part[part-1];
-    if ((p->boot & 0X7F) !=0  || p->totalSectors < 100 || p->firstSector == 0) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-    volumeStartBlock = p->firstSector;
-  }
-  pc = cacheFetch(volumeStartBlock, CACHE_FOR_READ);
-  if (!pc) {
-    DBG_FAIL_MACRO;
-    goto fail;
-  }
-  pbs = &(pc->pbs);
-  if (pbs->bytesPerSector != 512) {
-      DBG_FAIL_MACRO;
-      goto fail;
-  }
-  pfsCount_ = 1;
-  blocksPerCluster_ = pbs->sectorsPerCluster;
-  
-  // determine shift that is same as multiply by blocksPerCluster_
-  clusterSizeShift_ = 0;
-  while (blocksPerCluster_ != (1 << clusterSizeShift_)) {
-    // error if not power of 2
-    if (clusterSizeShift_++ > 7) {
-      DBG_FAIL_MACRO;
-      goto fail;
-    }
-  }
-
-  sectorsPerPfs_ = 1;
-
-  if (pfsCount_ > 0) cachePfsOffset_ = sectorsPerPfs_;
-  pfsStartBlock_ = volumeStartBlock + 1;
-
-  // directory start for PFS
-  rootDirStart_ = pfsStartBlock_ + pfsCount_ * sectorsPerPfs_;
-
-  // data start for PFS
-  dataStartBlock_ = rootDirStart_ + ((32 * pbs->rootDirEntryCount + 511)/512);
-  
-  totalBlocks = pbs->totalSectors;
-  
-  // total data blocks
-  clusterCount_ = totalBlocks - (dataStartBlock_ - volumeStartBlock);
-
-  // divide by cluster size to get cluster count
-  clusterCount_ >>= clusterSizeShift_;
-  rootDirEntryCount_ = pbs->rootDirEntryCount;
-
-  return true;
-
- fail:
-  return false;
+#include <SdVolume.h>
+#include <SdCrc.h>
+// macro for debug
+#define DBG_FAIL_MACRO  //  Serial.print(__FILE__);Serial.println(__LINE__)
+
+cache_t  SdVolume::cacheBuffer_[CACHE_WAYS];       // 512 byte buffers
+uint32_t SdVolume::cacheBlockNumber_[CACHE_WAYS];  // block in each buffer
+uint32_t SdVolume::cacheUse_[CACHE_WAYS];          // time of last use
+uint8_t  SdVolume::cacheStatus_[CACHE_WAYS];       // status of each buffer
+uint8_t  SdVolume::cachePinCount_[CACHE_WAYS];     // pins on each buffer
+uint32_t SdVolume::cacheUseCount_;     // clock for LRU replacement
+uint8_t  SdVolume::cacheCurrent_;      // buffer of last fetch
+uint32_t SdVolume::cachePfsOffset_;    // offset for mirrored PFS
+#if PFS_WINDOW_ENTRIES
+uint32_t SdVolume::pfsWindow_[2][PFS_WINDOW_ENTRIES];  // table entries
+uint32_t SdVolume::pfsWindowFirst_[2];  // first entry in each window
+uint8_t  SdVolume::pfsWindowLast_;      // window of the last lookup
+#endif  // PFS_WINDOW_ENTRIES
+bool     SdVolume::mirrorStale_;       // PFS_info marked stale
+#if PFS_MIRROR_MAP_SIZE
+bool     SdVolume::mirrorEvicted_;     // table block evicted since sync
+uint8_t  SdVolume::mirrorMap_[PFS_MIRROR_MAP_SIZE];  // stale mirror blocks
+uint8_t  SdVolume::mirrorShift_;       // log2 of blocks per map bit
+uint32_t SdVolume::mirrorBase_;        // first table block, 0 if not lazy
+#endif  // PFS_MIRROR_MAP_SIZE
+#if PFS_JOURNAL
+uint16_t SdVolume::cacheLogLo_[CACHE_WAYS];  // first changed byte
+uint16_t SdVolume::cacheLogHi_[CACHE_WAYS];  // end of changes, 0 if none
+cache_t  SdVolume::journalBuffer_;     // block of a transaction
+uint32_t SdVolume::journalBufferBlock_;  // block in journalBuffer_
+uint32_t SdVolume::journalStart_;      // first journal block
+uint16_t SdVolume::journalBlocks_;     // journal size, 0 if none
+uint16_t SdVolume::journalHead_;       // block of the next commit
+uint32_t SdVolume::journalSeq_;        // sequence of the next commit
+uint32_t SdVolume::journalDataLo_;     // first logged data area block
+uint32_t SdVolume::journalDataHi_;     // last logged data area block
+bool     SdVolume::journalRevoke_;     // logged blocks were freed
+SdVolume* SdVolume::journalVolume_;    // volume of the free count
+#endif  // PFS_JOURNAL
+Sd2Card* SdVolume::sdCard_;            // pointer to SD card object
+#if READ_AHEAD_BLOCKS
+cache_t  SdVolume::raBuffer_[READ_AHEAD_BLOCKS];        // read-ahead ring
+uint32_t SdVolume::raBlockNumber_[READ_AHEAD_BLOCKS];  // block in each buffer
+uint8_t  SdVolume::raHead_;             // oldest buffer
+uint8_t  SdVolume::raCount_;            // buffers in use
+uint32_t SdVolume::raStream_;           // next block of open CMD18
+#if ASYNC_SD_QUEUE
+bool     SdVolume::raBusy_[READ_AHEAD_BLOCKS];  // read not completed
+#endif  // ASYNC_SD_QUEUE
+#endif  // READ_AHEAD_BLOCKS
+#if ASYNC_SD_QUEUE
+uint8_t  SdVolume::asyncWay_[ASYNC_SD_QUEUE];  // buffer of each request
+uint8_t  SdVolume::asyncHead_;          // oldest request
+uint8_t  SdVolume::asyncCount_;         // requests queued
+#endif  // ASYNC_SD_QUEUE
+//------------------------------
+
+// Read the entry of cluster.  With PFS_WINDOW_ENTRIES the entry is read
+// into a window unless forWrite is true, which is used for a table block
+// that is about to be changed.
+bool SdVolume::pfsGet(uint32_t cluster, uint32_t* value, bool forWrite) {
+  uint32_t lba;
+  cache_t* pc;
+  // error if reserved cluster of beyond FAT
+  if (cluster < 2  || cluster > (clusterCount_ + 1)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if !PFS_WINDOW_ENTRIES
+  (void)forWrite;
+#else  // PFS_WINDOW_ENTRIES
+  if (!forWrite) {
+    // the cache buffer is left for data blocks
+    uint32_t* p = pfsWindowFetch(cluster);
+    if (!p) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    *value = *p & PFSMASK;
+    return true;
+  }
+#endif  // PFS_WINDOW_ENTRIES
+  lba = pfsStartBlock_ + (cluster >> 7);
+  pc = cacheFetchPfs(lba, CACHE_FOR_READ);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  *value = pc->fat32[cluster & 0X7F] & PFSMASK;
+
+  return true;
+
+ fail:
+  return false;
+}
+
+bool SdVolume::pfsPut(uint32_t cluster, uint32_t value) {
+  #if ENABLED_READ_ONLY
+  return true;
+  #else
+  uint32_t lba;
+  cache_t* pc;
+  if (cluster < 2 || cluster > (clusterCount_ + 1)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  lba = pfsStartBlock_ + (cluster >> 7);
+
+  pc = cacheFetchPfs(lba, CACHE_FOR_LOG);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  pc->fat32[cluster & 0X7F] = value;
+  cacheLog(cacheCurrent_, 4*(cluster & 0X7F), 4);
+  pfsWindowPut(cluster, 1, value);
+#if USE_PFS_BITMAP
+  if (bitmap_) bitmapPut(cluster, value != 0);
+#endif  // USE_PFS_BITMAP
+  return true;
+
+ fail:
+  return false;
+  #endif  //ENABLED_READ_ONLY
+}
+
+#if PFS_WINDOW_ENTRIES
+// Return the address of the entry for cluster in a window.  A missing
+// entry is copied from the cache buffer if it holds the table block, else
+// the aligned run of entries around it is read from the card into the
+// window not used last.
+uint32_t* SdVolume::pfsWindowFetch(uint32_t cluster) {
+  uint32_t first = cluster & ~(uint32_t)(PFS_WINDOW_ENTRIES - 1);
+  uint32_t lba = pfsStartBlock_ + (cluster >> 7);
+  uint8_t w;
+  for (w = 0; w < 2; w++) {
+    if (pfsWindowFirst_[w] == first) goto found;
+  }
+  w = pfsWindowLast_ ^ 1;
+  pfsWindowFirst_[w] = 0XFFFFFFFF;
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) {
+    // the cached copy may be newer than the card
+    if (cacheBlockNumber_[i] == lba) {
+      memcpy(pfsWindow_[w], &cacheBuffer_[i].fat32[first & 0X7F],
+             sizeof(pfsWindow_[w]));
+      goto read;
+    }
+  }
+  if (!cardIdle() || !sdCard_->readPart(lba, 4*(first & 0X7F),
+    sizeof(pfsWindow_[w]), reinterpret_cast<uint8_t*>(pfsWindow_[w]))) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+
+ read:
+  pfsWindowFirst_[w] = first;
+
+ found:
+  pfsWindowLast_ = w;
+  return &pfsWindow_[w][cluster - first];
+
+ fail:
+  return 0;
+}
+
+// Update window entries of clusters [cluster, cluster + count) that are
+// linked in order with value in the last one, or all set to zero.
+void SdVolume::pfsWindowPut(uint32_t cluster, uint32_t count, uint32_t value) {
+  for (uint8_t w = 0; w < 2; w++) {
+    if (pfsWindowFirst_[w] == 0XFFFFFFFF) continue;
+    for (uint8_t i = 0; i < PFS_WINDOW_ENTRIES; i++) {
+      uint32_t k = pfsWindowFirst_[w] + i - cluster;
+      if (k >= count) continue;
+      if (value == 0) {
+        pfsWindow_[w][i] = 0;
+      } else {
+        pfsWindow_[w][i] = (k + 1) < count ? cluster + k + 1 : value;
+      }
+    }
+  }
+}
+#endif  // PFS_WINDOW_ENTRIES
+
+// Fetch the table block for entries [cluster, cluster + count) to change
+// and set *n to the entries of the range in that block.  A block the range
+// covers completely is not read.
+cache_t* SdVolume::pfsFetchRange(uint32_t cluster, uint32_t count,
+                                 uint16_t* n) {
+  uint16_t i = cluster & 0X7F;
+  cache_t* pc;
+  *n = count < (128U - i) ? count : 128 - i;
+  pc = cacheFetchPfs(pfsStartBlock_ + (cluster >> 7), *n == 128
+                     ? CACHE_RESERVE_FOR_WRITE | CACHE_STATUS_LOGGED
+                     : CACHE_FOR_LOG);
+  if (pc) cacheLog(cacheCurrent_, 4*i, 4*(*n));
+  return pc;
+}
+
+// Link clusters [cluster, cluster + count) in order and set the entry of
+// the last one to value.  Each table block is fetched once.
+bool SdVolume::pfsPutRange(uint32_t cluster, uint32_t count, uint32_t value) {
+  #if ENABLED_READ_ONLY
+  return true;
+  #else
+  uint32_t c = cluster;
+  uint32_t todo = count;
+  if (count == 0 || cluster < 2 || (cluster + count) > (clusterCount_ + 2)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  while (todo) {
+    uint16_t n;
+    cache_t* pc = pfsFetchRange(c, todo, &n);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    uint32_t* p = &pc->fat32[c & 0X7F];
+    for (uint16_t i = 0; i < n; i++) p[i] = c + i + 1;
+    c += n;
+    todo -= n;
+    if (todo == 0) p[n - 1] = value;
+  }
+  pfsWindowPut(cluster, count, value);
+#if USE_PFS_BITMAP
+  if (bitmap_) bitmapPutRange(cluster, count, true);
+#endif  // USE_PFS_BITMAP
+  return true;
+
+ fail:
+  return false;
+  #endif  //ENABLED_READ_ONLY
+}
+
+// Mark clusters [cluster, cluster + count) free.  Each table block is
+// fetched once.
+bool SdVolume::pfsFreeRange(uint32_t cluster, uint32_t count) {
+  #if ENABLED_READ_ONLY
+  return true;
+  #else
+  uint32_t c = cluster;
+  uint32_t todo = count;
+  if (count == 0 || cluster < 2 || (cluster + count) > (clusterCount_ + 2)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  while (todo) {
+    uint16_t n;
+    cache_t* pc = pfsFetchRange(c, todo, &n);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    memset(&pc->fat32[c & 0X7F], 0, 4*n);
+    c += n;
+    todo -= n;
+  }
+  pfsWindowPut(cluster, count, 0);
+#if USE_PFS_BITMAP
+  if (bitmap_) bitmapPutRange(cluster, count, false);
+#endif  // USE_PFS_BITMAP
+  return true;
+
+ fail:
+  return false;
+  #endif  //ENABLED_READ_ONLY
+}
+
+bool SdVolume::allocContiguous(uint32_t count, uint32_t* curCluster) {
+  // start of group
+  uint32_t bgnCluster;
+  // end of group
+  uint32_t endCluster;
+  // last cluster of FAT
+  uint32_t fatEnd = clusterCount_ + 1;
+
+  // flag to save place to start next search
+  bool setStart;
+
+#if PFS_JOURNAL
+  // freed clusters that hold logged blocks may be reused after this
+  if (journalRevoke_ && !cacheSync()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#endif  // PFS_JOURNAL
+  if (!infoMarkStale()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // set search start cluster
+  if (*curCluster) {
+    // try to make file contiguous
+    bgnCluster = *curCluster + 1;
+
+    // don't save new start location
+    setStart = false;
+  } else {
+    // start at likely place for free cluster
+    bgnCluster = allocSearchStart_;
+
+    // save next search start if one cluster
+    setStart = count == 1;
+  }
+  // end of group
+  endCluster = bgnCluster;
+
+#if USE_PFS_BITMAP
+  if (bitmap_) {
+    bgnCluster = bitmapFind(bgnCluster, count);
+    if (bgnCluster == 0) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    endCluster = bgnCluster + count - 1;
+  } else  // NOLINT
+#endif  // USE_PFS_BITMAP
+  // search the FAT for free clusters
+  for (uint32_t n = 0;; n++, endCluster++) {
+    // can't find space checked all clusters
+    if (n >= clusterCount_) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // past end - start from beginning of FAT
+    if (endCluster > fatEnd) {
+      bgnCluster = endCluster = 2;
+    }
+    uint32_t f;
+    // the block holding a free cluster is changed next
+    if (!pfsGet(endCluster, &f, true)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+
+    if (f != 0) {
+      // cluster in use try next cluster as bgnCluster
+      bgnCluster = endCluster + 1;
+    } else if ((endCluster - bgnCluster + 1) == count) {
+      // done - found space
+      break;
+    }
+  }
+  // link clusters and mark end of chain
+  if (!pfsPutRange(bgnCluster, count, 0x0FFFFFFF)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (*curCluster != 0) {
+    // connect chains
+    if (!pfsPut(*curCluster, bgnCluster)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  // a queued erase would destroy data written before the next sync
+  eraseCancel(bgnCluster, count);
+
+  // return first cluster number to caller
+  *curCluster = bgnCluster;
+
+  // remember possible next free cluster
+  if (setStart) allocSearchStart_ = bgnCluster + 1;
+  freeCountAdd(-(int32_t)count);
+
+  return true;
+
+ fail:
+  return false;
+}
+
+#if DIR_HASH_SIZE
+// Start an empty hash for the directory at cluster, zero for no hash.
+void SdVolume::dirHashClear(uint32_t cluster) {
+  dirHashCluster_ = cluster;
+  dirHashFull_ = false;
+  dirHashUsed_ = 0;
+  dirHashRemoved_ = 0;
+  dirHashFree_ = 0;
+  memset(dirHash_, 0, sizeof(dirHash_));
+}
+
+// Add a name that is not in the hash, reusing the slot of a removed name
+// if the probe passes one.  When the hash is too full to probe quickly it
+// is rebuilt without the removed names or, if it has none, marked full so
+// the directory is searched linearly without being hashed again.
+void SdVolume::dirHashInsert(const uint8_t* name, uint32_t entry) {
+  uint16_t i = dirHashSlot(name);
+  if (dirHashFull_) return;
+  if (entry >= (DIR_HASH_REMOVED - 1)) {
+    dirHashFull_ = true;
+    return;
+  }
+  while (dirHash_[i] && dirHash_[i] != DIR_HASH_REMOVED) {
+    i = (i + 1) & (DIR_HASH_SIZE - 1);
+  }
+  if (dirHash_[i] == DIR_HASH_REMOVED) {
+    dirHashRemoved_--;
+  } else if (dirHashUsed_ >= (DIR_HASH_SIZE/4)*3) {
+    if (dirHashRemoved_) {
+      dirHashCluster_ = 0;
+    } else {
+      dirHashFull_ = true;
+    }
+    return;
+  } else {
+    dirHashUsed_++;
+  }
+  dirHash_[i] = entry + 1;
+}
+
+// Mark the slot of a removed name so probes for other names continue past
+// it.  A create can use the entry again.
+void SdVolume::dirHashRemove(const uint8_t* name, uint32_t entry) {
+  for (uint16_t i = dirHashSlot(name); dirHash_[i];
+       i = (i + 1) & (DIR_HASH_SIZE - 1)) {
+    if (dirHash_[i] == (entry + 1)) {
+      dirHash_[i] = DIR_HASH_REMOVED;
+      dirHashRemoved_++;
+      break;
+    }
+  }
+  if (entry < dirHashFree_) dirHashFree_ = entry;
+}
+
+// FNV-1a of the 11 byte name.
+uint16_t SdVolume::dirHashSlot(const uint8_t* name) {
+  uint32_t h = 2166136261UL;
+  for (uint8_t i = 0; i < 11; i++) {
+    h = (h ^ name[i])*16777619UL;
+  }
+  return (h ^ (h >> 16)) & (DIR_HASH_SIZE - 1);
+}
+#endif  // DIR_HASH_SIZE
+
+#if USE_PFS_BITMAP
+// Build the bitmap from the PFS table.  Reserved clusters and bits past
+// the end of the table are marked in use.
+bool SdVolume::bitmapInit() {
+  uint32_t words = (clusterCount_ + 2 + 31) >> 5;
+  uint32_t lba = pfsStartBlock_;
+  uint32_t todo = clusterCount_ + 2;
+  uint32_t cluster = 0;
+  int32_t free = 0;
+
+  ::free(bitmap_);
+  bitmap_ = reinterpret_cast<uint32_t*>(malloc(4*words));
+  if (!bitmap_) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  memset(bitmap_, 0XFF, 4*words);
+  while (todo) {
+    cache_t* pc = cacheFetchPfs(lba++, CACHE_FOR_READ);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    uint16_t n = todo < 128 ? todo : 128;
+    for (uint16_t i = 0; i < n; i++, cluster++) {
+      if (cluster >= 2 && (pc->fat32[i] & PFSMASK) == 0) {
+        bitmapPut(cluster, false);
+        free++;
+      }
+    }
+    todo -= n;
+  }
+  // the scan gives an exact count for free
+  if (free != freeCount_) {
+    freeCount_ = free;
+    infoDirty_ = true;
+  }
+  return true;
+
+ fail:
+  ::free(bitmap_);
+  bitmap_ = 0;
+  return false;
+}
+
+// Find count free clusters in a row starting the search at cluster start
+// and wrapping at the end of the table.  Words with no free cluster are
+// skipped and free words are taken whole.  Return zero if none found.
+uint32_t SdVolume::bitmapFind(uint32_t start, uint32_t count) {
+  uint32_t fatEnd = clusterCount_ + 1;
+  uint32_t bgn = 0;
+  uint32_t run = 0;
+  uint32_t c = start;
+  for (uint32_t n = 0; n < clusterCount_;) {
+    if (c > fatEnd) {
+      // a run can't wrap past the end
+      c = 2;
+      run = 0;
+    }
+    uint32_t w = bitmap_[c >> 5];
+    if ((c & 31) == 0 && w == 0XFFFFFFFF) {
+      run = 0;
+      c += 32;
+      n += 32;
+    } else if ((c & 31) == 0 && w == 0 && (c + 31) <= fatEnd) {
+      if (run == 0) bgn = c;
+      run += 32;
+      if (run >= count) return bgn;
+      c += 32;
+      n += 32;
+    } else {
+      if (w & (1UL << (c & 31))) {
+        run = 0;
+      } else {
+        if (run == 0) bgn = c;
+        if (++run == count) return bgn;
+      }
+      c++;
+      n++;
+    }
+  }
+  return 0;
+}
+
+// Set the bits of clusters [cluster, cluster + count), whole words at a
+// time.
+void SdVolume::bitmapPutRange(uint32_t cluster, uint32_t count, bool used) {
+  while (count && (cluster & 31)) {
+    bitmapPut(cluster++, used);
+    count--;
+  }
+  memset(&bitmap_[cluster >> 5], used ? 0XFF : 0, 4*(count >> 5));
+  cluster += count & ~31UL;
+  count &= 31;
+  while (count--) bitmapPut(cluster++, used);
+}
+#endif  // USE_PFS_BITMAP
+
+uint32_t SdVolume::clusterStartBlock(uint32_t cluster) const {
+  return dataStartBlock_ + ((cluster - 2)*blocksPerCluster_);
+}
+
+// Free a cluster chain.  If count is nonzero the chain is count adjacent
+// clusters, which is checked by reading only the entry of the last one.
+// Otherwise the chain is followed a table block at a time and each run of
+// adjacent clusters in a block is freed at once.
+bool SdVolume::freeChain(uint32_t cluster, uint32_t count) {
+  #if ENABLED_READ_ONLY
+  return true;
+  #else
+  uint32_t next;
+  uint32_t last;
+#if ERASE_FREED_CLUSTERS
+  uint32_t runStart = cluster;  // first cluster of a run of adjacent clusters
+#endif  // ERASE_FREED_CLUSTERS
+
+  if (!infoMarkStale()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // search for free clusters from the first one freed
+  if (cluster < allocSearchStart_) allocSearchStart_ = cluster;
+
+  if (count && pfsGet(cluster + count - 1, &last) && isEOC(last)) {
+    if (!pfsFreeRange(cluster, count)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    freeCountAdd(count);
+    journalFree(cluster, count);
+#if ERASE_FREED_CLUSTERS
+    if (eraseOnFree_) eraseQueue(cluster, cluster + count - 1);
+#endif  // ERASE_FREED_CLUSTERS
+    return true;
+  }
+  do {
+    if (cluster < 2 || cluster > (clusterCount_ + 1)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    cache_t* pc = cacheFetchPfs(pfsStartBlock_ + (cluster >> 7),
+                                CACHE_FOR_READ);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // length of the run of adjacent clusters in this block
+    uint16_t i = cluster & 0X7F;
+    uint16_t n = 1;
+    while ((i + n) < 128 && (pc->fat32[i + n - 1] & PFSMASK) == cluster + n) {
+      n++;
+    }
+    next = pc->fat32[i + n - 1] & PFSMASK;
+    if (!pfsFreeRange(cluster, n)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    freeCountAdd(n);
+    journalFree(cluster, n);
+#if ERASE_FREED_CLUSTERS
+    if (eraseOnFree_ && next != cluster + n) {
+      eraseQueue(runStart, cluster + n - 1);
+      runStart = next;
+    }
+#endif  // ERASE_FREED_CLUSTERS
+
+    cluster = next;
+  } while (!isEOC(cluster));
+
+  return true;
+
+ fail:
+  return false;
+  #endif
+}
+
+#if PFS_JOURNAL
+// Note freed clusters that hold blocks logged since the journal was
+// started.  A replay would copy the old directory bytes over data written
+// to them after they are reused, so the journal is started over first.
+void SdVolume::journalFree(uint32_t cluster, uint32_t count) {
+  uint32_t bgn = clusterStartBlock(cluster);
+  uint32_t end = bgn + count*blocksPerCluster_;
+  if (bgn <= journalDataHi_ && end > journalDataLo_) journalRevoke_ = true;
+}
+#endif  // PFS_JOURNAL
+
+#if ERASE_FREED_CLUSTERS
+/**
+ * Erase clusters when they are freed.
+ *
+ * Clusters freed by SdBaseFile::truncate() and SdBaseFile::remove() are
+ * erased in runs of adjacent clusters, so rewriting the space does not
+ * wait for the card to erase flash.  If the card can't erase single
+ * blocks only whole erase sectors inside a run are erased.  The runs are
+ * erased by the next sync() after the change that frees them is on the
+ * card, so a power loss before it leaves the file intact.
+ *
+ * \param[in] enable True to erase freed clusters.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned if the CSD can't be read.
+ */
+bool SdVolume::eraseOnFree(bool enable) {
+  csd_t csd;
+  eraseOnFree_ = false;
+  eraseMask_ = 0;
+  if (!enable) return true;
+  if (!cardIdle()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (!sdCard_->eraseSingleBlockEnable()) {
+    // erase sector size mask, as checked by Sd2Card::erase()
+    if (!sdCard_->readCSD(&csd)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    eraseMask_ = (csd.v1.sector_size_high << 1) | csd.v1.sector_size_low;
+  }
+  eraseOnFree_ = true;
+  return true;
+
+ fail:
+  return false;
+}
+
+// Forget queued runs that share a cluster with count clusters at first,
+// which are allocated again.
+void SdVolume::eraseCancel(uint32_t first, uint32_t count) {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < eraseCount_; i++) {
+    if (eraseLast_[i] < first || eraseFirst_[i] >= (first + count)) {
+      eraseFirst_[n] = eraseFirst_[i];
+      eraseLast_[n++] = eraseLast_[i];
+    }
+  }
+  eraseCount_ = n;
+}
+
+// Remember freed clusters [first, last] for the next sync().  A run that
+// does not fit is not erased.
+void SdVolume::eraseQueue(uint32_t first, uint32_t last) {
+  if (eraseCount_ < ERASE_FREED_CLUSTERS) {
+    eraseFirst_[eraseCount_] = first;
+    eraseLast_[eraseCount_++] = last;
+  }
+}
+
+// Erase the queued runs once the frees are committed.
+void SdVolume::eraseQueued() {
+  for (uint8_t i = 0; i < eraseCount_ && eraseOnFree_; i++) {
+    eraseRun(eraseFirst_[i], eraseLast_[i]);
+  }
+  eraseCount_ = 0;
+}
+
+// Erase the blocks of freed clusters [first, last].  Erase only saves
+// time later so a card that fails an erase is not asked again.
+void SdVolume::eraseRun(uint32_t first, uint32_t last) {
+  uint32_t bgn = clusterStartBlock(first);
+  uint32_t end = clusterStartBlock(last) + blocksPerCluster_;
+  // cached copies of the freed clusters are clean after the sync
+  cacheInvalidate(bgn, end - bgn);
+  bgn = (bgn + eraseMask_) & ~(uint32_t)eraseMask_;
+  end &= ~(uint32_t)eraseMask_;
+  if (bgn >= end) return;
+  if (!cardIdle() || !sdCard_->erase(bgn, end - 1)) eraseOnFree_ = false;
+}
+#endif  // ERASE_FREED_CLUSTERS
+
+/** \return The number of free clusters or -1 for an error.
+ *
+ * The count is kept up to date by allocation and loaded from PFS_info at
+ * mount, the table is only scanned if PFS_info was missing or invalid or
+ * the volume was changed and not synced before it was last removed.
+ */
+int32_t SdVolume::freeClusterCount() {
+  uint32_t free = 0;
+  uint32_t lba;
+  uint32_t todo = clusterCount_ + 2;
+  uint16_t n;
+
+  if (freeCount_ >= 0) return freeCount_;
+  lba = pfsStartBlock_;
+  while (todo) {
+    cache_t* pc = cacheFetchPfs(lba++, CACHE_FOR_READ);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    n = 128;
+    if (todo < n) n = todo;
+    // skip reserved entries 0 and 1
+    for (uint16_t i = lba == (pfsStartBlock_ + 1) ? 2 : 0; i < n; i++) {
+      if (pc->fat32[i] == 0) free++;
+    }    
+    todo -= n;
+  }
+  freeCount_ = free;
+  infoDirty_ = true;
+  return free;
+
+ fail:
+  return -1;
+}
+
+/** Write the free count and next free hint to PFS_info and flush the
+ * cache.  On a volume with a journal the changed data blocks are written
+ * and the table and directory changes are committed to the journal.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdVolume::sync() {
+#if PFS_JOURNAL
+  if (journalBlocks_) {
+    if (!journalCommit()) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    eraseQueued();
+    return true;
+  }
+#endif  // PFS_JOURNAL
+  if (mirrorStale_ && !mirrorSync(false)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if PFS_MIRROR_MAP_SIZE
+  mirrorEvicted_ = false;
+#endif  // PFS_MIRROR_MAP_SIZE
+  if (infoDirty_ && infoBlock_ && !ENABLED_READ_ONLY) {
+    // the table is on the card before PFS_info counts it
+    if (!cacheWritePfs()) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    cache_t* pc = cacheFetch(infoBlock_, CACHE_FOR_WRITE);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    pc->fsinfo.freeCount = freeCount_ >= 0 ? freeCount_ : 0XFFFFFFFF;
+    pc->fsinfo.nextFree = allocSearchStart_;
+    infoDirty_ = false;
+    infoStale_ = freeCount_ < 0;
+  }
+  if (!cacheSync()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  eraseQueued();
+  return true;
+
+ fail:
+  return false;
+}
+
+// Write PFS_info with no free count before the first change to the count
+// after a sync, so init() does not trust it if power is lost before the
+// next sync.  A journal replays its own count.
+bool SdVolume::infoMarkStale() {
+  #if ENABLED_READ_ONLY
+  return true;
+  #else
+  cache_t* pc;
+  if (infoStale_ || !infoBlock_) return true;
+#if PFS_JOURNAL
+  if (journalBlocks_) return true;
+#endif  // PFS_JOURNAL
+  pc = cacheFetch(infoBlock_, CACHE_FOR_WRITE);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  pc->fsinfo.freeCount = 0XFFFFFFFF;
+  if (!cacheWrite(cacheCurrent_)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  infoStale_ = true;
+  // sync() writes the count
+  infoDirty_ = true;
+  return true;
+
+ fail:
+  return false;
+  #endif  // ENABLED_READ_ONLY
+}
+
+// Copy table blocks to the mirror, all of them or those in mirrorMap_, and
+// clear the marker in the cached PFS_info block.  The caller writes it.
+// Blocks written by cacheSync() go to both tables.
+bool SdVolume::mirrorSync(bool all) {
+  cache_t* pc;
+  // the first table must be on the card before the marker is cleared
+  if (!cacheSync()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if !PFS_MIRROR_MAP_SIZE
+  (void)all;
+#endif  // PFS_MIRROR_MAP_SIZE
+  for (uint32_t b = 0; b < sectorsPerPfs_; b++) {
+#if PFS_MIRROR_MAP_SIZE
+    uint32_t g = b >> mirrorShift_;
+    if (!all && !(mirrorMap_[g >> 3] & (1 << (g & 7)))) continue;
+#endif  // PFS_MIRROR_MAP_SIZE
+    pc = cacheFetchPfs(pfsStartBlock_ + b, CACHE_FOR_READ);
+    if (!pc || !writeBlock(pfsStartBlock_ + b + cachePfsOffset_, pc->data)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+#if PFS_MIRROR_MAP_SIZE
+  memset(mirrorMap_, 0, sizeof(mirrorMap_));
+#endif  // PFS_MIRROR_MAP_SIZE
+  pc = cacheFetch(infoBlock_, CACHE_FOR_WRITE);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  pc->fsinfo.mirrorState = 0;
+  mirrorStale_ = false;
+  return true;
+
+ fail:
+  return false;
+}
+
+#if PFS_JOURNAL
+// Log the change of bytes [offset, offset + count) of buffer i.  One range
+// is kept for each buffer, it grows to cover all changes to the block.
+void SdVolume::cacheLog(uint8_t i, uint16_t offset, uint16_t count) {
+  if (!journalBlocks_) return;
+  if (cacheLogHi_[i] == 0) {
+    cacheLogLo_[i] = offset;
+    cacheLogHi_[i] = offset + count;
+  } else {
+    if (offset < cacheLogLo_[i]) cacheLogLo_[i] = offset;
+    if ((offset + count) > cacheLogHi_[i]) cacheLogHi_[i] = offset + count;
+  }
+  cacheStatus_[i] |= CACHE_STATUS_DIRTY | CACHE_STATUS_LOGGED;
+  // directory blocks are in clusters that may be freed
+  if (!(cacheStatus_[i] & CACHE_STATUS_PFS_BLOCK)) {
+    uint32_t b = cacheBlockNumber_[i];
+    if (b < journalDataLo_) journalDataLo_ = b;
+    if (b > journalDataHi_) journalDataHi_ = b;
+  }
+}
+
+// Copy the n bytes at src that start at *pos, a byte offset from the start
+// of dst that may be negative, to the part of them inside the block.
+static void journalCopy(uint8_t* dst, int32_t* pos, const void* src,
+                        uint16_t n) {
+  int32_t bgn = *pos < 0 ? 0 : *pos;
+  int32_t end = (*pos + n) < 512 ? *pos + n : 512;
+  if (end > bgn) {
+    memcpy(dst + bgn, reinterpret_cast<const uint8_t*>(src) + (bgn - *pos),
+           end - bgn);
+  }
+  *pos += n;
+}
+
+// Build bytes [512*k, 512*k + 512) of the transaction of the logged ranges
+// in journalBuffer_ and, if crc is not null, add the bytes after the header
+// to *crc.  The header is left for the caller.
+void SdVolume::journalFill(uint16_t k, uint16_t* crc) {
+  uint8_t* dst = journalBuffer_.data;
+  int32_t pos = sizeof(pfs_journal_t) - 512L*k;
+  journalBufferBlock_ = 0XFFFFFFFF;
+  memset(dst, 0, 512);
+  for (uint8_t i = 0; i < CACHE_WAYS && pos < 512; i++) {
+    if (cacheLogHi_[i] == 0) continue;
+    pfs_journal_record_t r;
+    r.block = cacheBlockNumber_[i];
+    r.offset = cacheLogLo_[i];
+    r.count = cacheLogHi_[i] - cacheLogLo_[i];
+    journalCopy(dst, &pos, &r, sizeof(r));
+    journalCopy(dst, &pos, cacheBuffer_[i].data + r.offset, r.count);
+  }
+  if (crc) {
+    int32_t bgn = k ? 0 : sizeof(pfs_journal_t);
+    int32_t end = pos < 512 ? pos : 512;
+    if (end > bgn) *crc = CRC_CCITT(dst + bgn, end - bgn, *crc);
+  }
+}
+
+// Commit the changes logged since the last commit as one transaction.
+// Dirty data blocks are written first so a replayed directory entry never
+// points at data that is not on the card.  The first block of the
+// transaction, with the header, is written last.  The journal is started
+// over if the largest transaction might not fit after this one.  A journal
+// made smaller than that, possibly for a build with fewer cache buffers,
+// can't hold every transaction, one that does not fit is written in place
+// as on a volume without a journal.
+bool SdVolume::journalCommit() {
+  pfs_journal_t* h = reinterpret_cast<pfs_journal_t*>(journalBuffer_.data);
+  uint32_t lba = journalStart_ + journalHead_;
+  uint32_t bytes = sizeof(pfs_journal_t);
+  uint16_t crc = 0;
+  uint16_t n;
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) {
+    if (cacheLogHi_[i]) {
+      bytes += sizeof(pfs_journal_record_t) + cacheLogHi_[i] - cacheLogLo_[i];
+    } else if (!(cacheStatus_[i] & CACHE_STATUS_LOGGED) && !cacheWrite(i)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  if (!asyncWait()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  if (bytes == sizeof(pfs_journal_t)) return true;
+  n = (bytes + 511) >> 9;
+  if ((journalHead_ + n) > journalBlocks_) {
+    // a header with no records ends the chain of older transactions so a
+    // replay can't undo the writes in place, the free count is unknown
+    // after a power loss during them
+    memset(journalBuffer_.data, 0, 512);
+    journalBufferBlock_ = 0XFFFFFFFF;
+    h->signature = PFS_JOURNAL_SIG;
+    h->sequence = journalSeq_++;
+    h->blockCount = 1;
+    h->byteCount = sizeof(pfs_journal_t);
+    h->freeCount = 0XFFFFFFFF;
+    h->nextFree = journalVolume_->allocSearchStart_;
+    if (!cardIdle()
+      || !sdCard_->writeBlock(journalStart_, journalBuffer_.data)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    for (uint8_t i = 0; i < CACHE_WAYS; i++) cacheLogHi_[i] = 0;
+    return cacheSync();
+  }
+  journalFill(0, &crc);
+  if (n > 1) {
+    if (!cardIdle() || !sdCard_->writeStart(lba + 1, n - 1)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    for (uint16_t k = 1; k < n; k++) {
+      journalFill(k, &crc);
+      if (!sdCard_->writeData(journalBuffer_.data)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    }
+    if (!sdCard_->writeStop()) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    journalFill(0, 0);
+  }
+  h->signature = PFS_JOURNAL_SIG;
+  h->sequence = journalSeq_;
+  h->blockCount = n;
+  h->checksum = crc;
+  h->byteCount = bytes;
+  h->freeCount = journalVolume_->freeCount_ >= 0
+                 ? journalVolume_->freeCount_ : 0XFFFFFFFF;
+  h->nextFree = journalVolume_->allocSearchStart_;
+  if (!cardIdle() || !sdCard_->writeBlock(lba, journalBuffer_.data)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) cacheLogHi_[i] = 0;
+  journalSeq_++;
+  journalHead_ += n;
+  if ((journalHead_ + JOURNAL_MAX_BLOCKS) > journalBlocks_) return cacheSync();
+  return true;
+
+ fail:
+  return false;
+}
+
+// Read journal block b into journalBuffer_ unless it is there.
+bool SdVolume::journalLoad(uint16_t b) {
+  if (journalBufferBlock_ == (journalStart_ + b)) return true;
+  journalBufferBlock_ = 0XFFFFFFFF;
+  if (!cardIdle()
+    || !sdCard_->readBlock(journalStart_ + b, journalBuffer_.data)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  journalBufferBlock_ = journalStart_ + b;
+  return true;
+
+ fail:
+  return false;
+}
+
+// Read count bytes at byte pos of the journal.
+bool SdVolume::journalRead(uint32_t pos, void* dst, uint16_t count) {
+  uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+  while (count) {
+    uint16_t i = pos & 0X1FF;
+    uint16_t n = count < (512 - i) ? count : 512 - i;
+    if (!journalLoad(pos >> 9)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    memcpy(d, journalBuffer_.data + i, n);
+    d += n;
+    pos += n;
+    count -= n;
+  }
+  return true;
+
+ fail:
+  return false;
+}
+
+// Replay the journal of blocks at start.  Transactions are applied in
+// order from the first block while each has the next sequence number and a
+// good checksum, the blocks they change are written in place and the next
+// commit starts the journal over.  Its sequence number follows every one
+// found in the journal so stale transactions are never replayed after it.
+bool SdVolume::journalInit(uint32_t start, uint16_t blocks) {
+  bool replay = true;
+  journalStart_ = start;
+  journalBlocks_ = 0;
+  journalBufferBlock_ = 0XFFFFFFFF;
+  journalSeq_ = 1;
+  for (uint16_t b = 0; b < blocks; b++) {
+    pfs_journal_t h;
+    uint32_t pos = 512UL*b;
+    uint32_t end;
+    uint16_t crc = 0;
+    if (!journalRead(pos, &h, sizeof(h))) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (h.signature != PFS_JOURNAL_SIG) {
+      replay = false;
+      continue;
+    }
+    end = pos + h.byteCount;
+    if (!replay || (b && h.sequence != journalSeq_) || h.blockCount == 0
+      || h.blockCount > (blocks - b) || h.byteCount < sizeof(h)
+      || h.byteCount > 512UL*h.blockCount) {
+      goto stale;
+    }
+    for (uint32_t p = pos + sizeof(h); p < end; p = (p | 0X1FF) + 1) {
+      uint16_t i = p & 0X1FF;
+      uint16_t n = (end - p) < (512U - i) ? end - p : 512 - i;
+      if (!journalLoad(p >> 9)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      crc = CRC_CCITT(journalBuffer_.data + i, n, crc);
+    }
+    if (crc != h.checksum) goto stale;
+    for (pos += sizeof(h); pos < end;) {
+      pfs_journal_record_t r;
+      cache_t* pc;
+      if (!journalRead(pos, &r, sizeof(r))) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      pos += sizeof(r);
+      if (r.count == 0 || (r.offset + r.count) > 512
+        || (pos + r.count) > end) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      pc = cacheFetch(r.block, (r.count == 512 ? CACHE_RESERVE_FOR_WRITE
+                               : CACHE_FOR_WRITE)
+                      | ((r.block - pfsStartBlock_) < sectorsPerPfs_
+                         ? CACHE_STATUS_PFS_BLOCK : 0));
+      if (!pc || !journalRead(pos, pc->data + r.offset, r.count)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+      pos += r.count;
+    }
+    freeCount_ = h.freeCount <= clusterCount_ ? (int32_t)h.freeCount : -1;
+    if (h.nextFree >= 2 && h.nextFree <= (clusterCount_ + 1)) {
+      allocSearchStart_ = h.nextFree;
+    }
+    infoDirty_ = true;
+    journalSeq_ = h.sequence + 1;
+    b += h.blockCount - 1;
+    continue;
+
+   stale:
+    replay = false;
+    if ((h.sequence - journalSeq_) < 0X80000000) journalSeq_ = h.sequence + 1;
+  }
+  journalVolume_ = this;
+  journalBlocks_ = blocks;
+  return cacheSync();
+
+ fail:
+  return false;
+}
+#endif  // PFS_JOURNAL
+
+// Buffers [first, last) may hold the block.  Table blocks use the
+// reserved buffers if USE_SEPARATE_PFS_CACHE is nonzero.
+static void cacheSet(uint8_t options, uint8_t* first, uint8_t* last) {
+  if (CACHE_PFS_WAYS == 0) {
+    *first = 0;
+    *last = CACHE_WAYS;
+  } else if (options & SdVolume::CACHE_STATUS_PFS_BLOCK) {
+    *first = 0;
+    *last = CACHE_PFS_WAYS;
+  } else {
+    *first = CACHE_PFS_WAYS;
+    *last = CACHE_WAYS;
+  }
+}
+
+cache_t* SdVolume::cacheFetchPfs(uint32_t blockNumber, uint8_t options) {
+  return cacheFetch(blockNumber, options | CACHE_STATUS_PFS_BLOCK);
+}
+
+cache_t* SdVolume::cacheFetch(uint32_t blockNumber, uint8_t options) {
+  uint8_t first;
+  uint8_t last;
+  uint8_t i;
+  cacheSet(options, &first, &last);
+  for (i = first; i < last; i++) {
+    if (cacheBlockNumber_[i] == blockNumber) goto found;
+  }
+#if ASYNC_SD_QUEUE
+  asyncPoll();
+  i = cacheVictim(first, last);
+  // the least recently used buffer is the oldest write, if still busy
+  while (cacheStatus_[i] & CACHE_STATUS_BUSY) asyncRetire();
+#else  // ASYNC_SD_QUEUE
+  i = cacheVictim(first, last);
+#endif  // ASYNC_SD_QUEUE
+  if (!cacheEvict(i)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  // buffer is empty until the read succeeds
+  cacheBlockNumber_[i] = 0XFFFFFFFF;
+  cacheStatus_[i] = 0;
+  cachePinCount_[i] = 0;
+  if (!(options & CACHE_OPTION_NO_READ)) {
+#if READ_AHEAD_BLOCKS
+    if (readAheadCopy(blockNumber, cacheBuffer_[i].data)) goto read;
+#endif  // READ_AHEAD_BLOCKS
+    if (!cardIdle()
+      || !sdCard_->readBlock(blockNumber, cacheBuffer_[i].data)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+#if READ_AHEAD_BLOCKS
+ read:
+#endif  // READ_AHEAD_BLOCKS
+  cacheBlockNumber_[i] = blockNumber;
+
+ found:
+  // a read-ahead copy of a block being changed is stale
+  if (options & CACHE_STATUS_DIRTY) {
+    readAheadInvalidate(blockNumber, 1);
+#if ASYNC_SD_QUEUE
+    while (cacheStatus_[i] & CACHE_STATUS_BUSY) asyncRetire();
+#endif  // ASYNC_SD_QUEUE
+#if PFS_JOURNAL
+    // a block with changes that are not logged is logged whole
+    if ((options & CACHE_STATUS_LOGGED)
+      ? (cacheStatus_[i] & (CACHE_STATUS_DIRTY | CACHE_STATUS_LOGGED))
+        == CACHE_STATUS_DIRTY
+      : (cacheStatus_[i] & CACHE_STATUS_LOGGED)) {
+      cacheLog(i, 0, 512);
+    }
+#endif  // PFS_JOURNAL
+  }
+  cacheStatus_[i] |= options & CACHE_STATUS_MASK;
+  cacheUse_[i] = ++cacheUseCount_;
+  cacheCurrent_ = i;
+  return &cacheBuffer_[i];
+
+ fail:
+  return 0;
+}
+
+// Pick the buffer to replace in [first, last).  An empty buffer is used
+// first, then the least recently used buffer that is not pinned and has no
+// uncommitted journal changes.  A buffer being written is empty only when
+// its request completes.
+uint8_t SdVolume::cacheVictim(uint8_t first, uint8_t last) {
+  uint8_t lru = last;
+  uint8_t lruRank = 0;
+  for (uint8_t i = first; i < last; i++) {
+    if (cacheBlockNumber_[i] == 0XFFFFFFFF
+      && !(cacheStatus_[i] & CACHE_STATUS_BUSY)) {
+      return i;
+    }
+    // pins and commits are only hints, an older buffer of lower rank wins
+    uint8_t rank = cachePinCount_[i] ? 2 : 0;
+#if PFS_JOURNAL
+    if (cacheLogHi_[i]) rank++;
+#endif  // PFS_JOURNAL
+    // compare ages so the clock may wrap
+    uint32_t age = cacheUseCount_ - cacheUse_[i];
+    if (lru == last || rank < lruRank
+      || (rank == lruRank && age > (cacheUseCount_ - cacheUse_[lru]))) {
+      lru = i;
+      lruRank = rank;
+    }
+  }
+  return lru;
+}
+
+// write buffer i if it is dirty, table blocks are also written to the mirror
+bool SdVolume::cacheWrite(uint8_t i) {
+  #if ENABLED_READ_ONLY
+  return true;
+  #else
+#if PFS_JOURNAL
+  // logged changes are committed before the block is written in place
+  if (cacheLogHi_[i] && !journalCommit()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#endif  // PFS_JOURNAL
+  if (cacheStatus_[i] & CACHE_STATUS_DIRTY) {
+    if (!cardIdle()) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (!sdCard_->writeBlock(cacheBlockNumber_[i], cacheBuffer_[i].data)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // mirror second PFS
+    if ((cacheStatus_[i] & CACHE_STATUS_PFS_BLOCK) && cachePfsOffset_) {
+      uint32_t lbn = cacheBlockNumber_[i] + cachePfsOffset_;
+      if (!sdCard_->writeBlock(lbn, cacheBuffer_[i].data)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+#if PFS_MIRROR_MAP_SIZE
+      // an evicted block is up to date again if its bit is its own
+      if (mirrorBase_ && mirrorShift_ == 0) {
+        uint32_t g = cacheBlockNumber_[i] - mirrorBase_;
+        mirrorMap_[g >> 3] &= ~(1 << (g & 7));
+      }
+#endif  // PFS_MIRROR_MAP_SIZE
+    }
+    cacheStatus_[i] &= ~(CACHE_STATUS_DIRTY | CACHE_STATUS_LOGGED);
+  }
+  return true;
+
+ fail:
+  return false;
+  #endif  // ENABLED_READ_ONLY
+}
+
+#if PFS_MIRROR_MAP_SIZE
+// Write buffer i before it is replaced.  A dirty table block is written
+// only to the first table and marked in mirrorMap_ for sync().  Marking
+// PFS_info costs a write so the first table block evicted after a sync is
+// mirrored at once.  The second is also mirrored and its buffer is used to
+// write PFS_MIRROR_STALE to PFS_info.
+bool SdVolume::cacheEvict(uint8_t i) {
+  #if ENABLED_READ_ONLY
+  return true;
+  #else
+  const uint8_t PFS_DIRTY = CACHE_STATUS_PFS_BLOCK | CACHE_STATUS_DIRTY;
+  if (!mirrorBase_ || (cacheStatus_[i] & PFS_DIRTY) != PFS_DIRTY) {
+    return cacheWrite(i);
+  }
+  if (!mirrorStale_) {
+    uint8_t j = i;
+    if (!cacheWrite(i)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    if (!mirrorEvicted_) {
+      mirrorEvicted_ = true;
+      return true;
+    }
+    // update a cached copy of PFS_info, else read it into buffer i
+    for (uint8_t k = 0; k < CACHE_WAYS; k++) {
+      if (cacheBlockNumber_[k] == (mirrorBase_ - 1)) j = k;
+    }
+    if (j == i) {
+      cacheBlockNumber_[i] = 0XFFFFFFFF;
+      if (!cardIdle()
+        || !sdCard_->readBlock(mirrorBase_ - 1, cacheBuffer_[i].data)) {
+        DBG_FAIL_MACRO;
+        goto fail;
+      }
+    }
+    cacheBuffer_[j].fsinfo.mirrorState = PFS_MIRROR_STALE;
+    if (!cardIdle()
+      || !sdCard_->writeBlock(mirrorBase_ - 1, cacheBuffer_[j].data)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    mirrorStale_ = true;
+    return true;
+  }
+  if (!cardIdle()
+    || !sdCard_->writeBlock(cacheBlockNumber_[i], cacheBuffer_[i].data)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  {
+    uint32_t g = (cacheBlockNumber_[i] - mirrorBase_) >> mirrorShift_;
+    mirrorMap_[g >> 3] |= 1 << (g & 7);
+  }
+  cacheStatus_[i] &= ~CACHE_STATUS_DIRTY;
+  return true;
+
+ fail:
+  return false;
+  #endif  // ENABLED_READ_ONLY
+}
+#endif  // PFS_MIRROR_MAP_SIZE
+
+bool SdVolume::cacheSync() {
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) {
+    if (!cacheWrite(i)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  // blocks written by asynchronous requests must be on the card
+  if (!asyncWait()) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if PFS_JOURNAL
+  // all logged changes are in place, the next commit starts the journal
+  journalHead_ = 0;
+  journalDataLo_ = 0XFFFFFFFF;
+  journalDataHi_ = 0;
+  journalRevoke_ = false;
+#endif  // PFS_JOURNAL
+  return true;
+
+ fail:
+  return false;
+}
+
+// write the buffer of the last fetch if it holds a data block
+bool SdVolume::cacheWriteData() {
+  if (cacheStatus_[cacheCurrent_]
+    & (CACHE_STATUS_PFS_BLOCK | CACHE_STATUS_LOGGED)) {
+    return true;
+  }
+#if ASYNC_SD_QUEUE && !ENABLED_READ_ONLY
+  // the card programs the block while the next one is filled
+  if (cacheStatus_[cacheCurrent_] & CACHE_STATUS_DIRTY) {
+    return asyncBegin(cacheBlockNumber_[cacheCurrent_], cacheCurrent_);
+  }
+#endif  // ASYNC_SD_QUEUE && !ENABLED_READ_ONLY
+  return cacheWrite(cacheCurrent_);
+}
+
+bool SdVolume::cacheWritePfs() {
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) {
+    if ((cacheStatus_[i] & CACHE_STATUS_PFS_BLOCK) && !cacheWrite(i)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  return true;
+
+ fail:
+  return false;
+}
+
+// true if a block in [blockNumber, blockNumber + count) is cached
+bool SdVolume::cacheHas(uint32_t blockNumber, uint32_t count) {
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) {
+    if ((cacheBlockNumber_[i] - blockNumber) < count) return true;
+  }
+  return false;
+}
+
+// drop cached copies of [blockNumber, blockNumber + count) without writing
+void SdVolume::cacheInvalidate(uint32_t blockNumber, uint32_t count) {
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) {
+    if ((cacheBlockNumber_[i] - blockNumber) < count) {
+      cacheBlockNumber_[i] = 0XFFFFFFFF;
+      // a buffer being written is not free until its request completes
+      cacheStatus_[i] &= CACHE_STATUS_BUSY;
+      cachePinCount_[i] = 0;
+#if PFS_JOURNAL
+      cacheLogHi_[i] = 0;
+#endif  // PFS_JOURNAL
+    }
+  }
+  readAheadInvalidate(blockNumber, count);
+}
+
+#if READ_AHEAD_BLOCKS
+// Read a block into the read-ahead ring unless it is there.  The oldest
+// block is dropped when the ring is full.  With ASYNC_SD_QUEUE the read is
+// queued on the card, else the block is read with the open CMD18 if it is
+// the next block of the stream.
+bool SdVolume::readAheadAdd(uint32_t blockNumber) {
+  uint8_t i;
+  for (uint8_t n = 0; n < raCount_; n++) {
+    if (raBlockNumber_[(raHead_ + n) % READ_AHEAD_BLOCKS] == blockNumber) {
+      return true;
+    }
+  }
+  // a cached copy may be newer than the card
+  if (cacheHas(blockNumber)) return true;
+  if (raCount_ == READ_AHEAD_BLOCKS) {
+#if ASYNC_SD_QUEUE
+    while (raBusy_[raHead_]) asyncRetire();
+#endif  // ASYNC_SD_QUEUE
+    raHead_ = (raHead_ + 1) % READ_AHEAD_BLOCKS;
+    raCount_--;
+  }
+#if ASYNC_SD_QUEUE
+  i = (raHead_ + raCount_) % READ_AHEAD_BLOCKS;
+  if (!asyncBegin(blockNumber, ASYNC_RING | i)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  raBlockNumber_[i] = blockNumber;
+  raCount_++;
+  return true;
+#else  // ASYNC_SD_QUEUE
+  if (raStream_ != blockNumber) {
+    if (!readAheadStop() || !sdCard_->readStart(blockNumber)) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+  // the stream is not usable after an error
+  raStream_ = 0XFFFFFFFF;
+  i = (raHead_ + raCount_) % READ_AHEAD_BLOCKS;
+  if (!sdCard_->readData(raBuffer_[i].data)) {
+    sdCard_->readStop();
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  raBlockNumber_[i] = blockNumber;
+  raCount_++;
+  raStream_ = blockNumber + 1;
+  return true;
+#endif  // ASYNC_SD_QUEUE
+
+ fail:
+  return false;
+}
+
+// Copy a block from the read-ahead ring, false if it is not there.
+bool SdVolume::readAheadCopy(uint32_t blockNumber, uint8_t* dst) {
+  for (uint8_t n = 0; n < raCount_; n++) {
+    uint8_t i = (raHead_ + n) % READ_AHEAD_BLOCKS;
+    if (raBlockNumber_[i] == blockNumber) {
+#if ASYNC_SD_QUEUE
+      while (raBusy_[i]) asyncRetire();
+      // a failed read empties the buffer
+      if (raBlockNumber_[i] != blockNumber) return false;
+#endif  // ASYNC_SD_QUEUE
+      memcpy(dst, raBuffer_[i].data, 512);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Forget ring copies of blocks that are written.
+void SdVolume::readAheadInvalidate(uint32_t blockNumber, uint32_t count) {
+  for (uint8_t n = 0; n < raCount_; n++) {
+    uint8_t i = (raHead_ + n) % READ_AHEAD_BLOCKS;
+    if ((raBlockNumber_[i] - blockNumber) < count) {
+      raBlockNumber_[i] = 0XFFFFFFFF;
+    }
+  }
+}
+
+// End the open CMD18, if any, before other card commands.
+bool SdVolume::readAheadStop() {
+  if (raStream_ == 0XFFFFFFFF) return true;
+  raStream_ = 0XFFFFFFFF;
+  return sdCard_->readStop();
+}
+#endif  // READ_AHEAD_BLOCKS
+
+#if ASYNC_SD_QUEUE
+// Queue a write of cache buffer way, or a read of read-ahead buffer
+// way & ~ASYNC_RING.  The oldest request is completed if the queue is full.
+bool SdVolume::asyncBegin(uint32_t blockNumber, uint8_t way) {
+  bool rtn;
+  asyncPoll();
+  if (asyncCount_ == ASYNC_SD_QUEUE) asyncRetire();
+#if READ_AHEAD_BLOCKS
+  if (way & ASYNC_RING) {
+    rtn = sdCard_->beginRead(blockNumber, raBuffer_[way & ~ASYNC_RING].data);
+    if (rtn) raBusy_[way & ~ASYNC_RING] = true;
+  } else
+#endif  // READ_AHEAD_BLOCKS
+  {
+    rtn = sdCard_->beginWrite(blockNumber, cacheBuffer_[way].data);
+    if (rtn) {
+      cacheStatus_[way] &= ~CACHE_STATUS_DIRTY;
+      cacheStatus_[way] |= CACHE_STATUS_BUSY;
+    }
+  }
+  if (!rtn) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  asyncWay_[(asyncHead_ + asyncCount_) % ASYNC_SD_QUEUE] = way;
+  asyncCount_++;
+  return true;
+
+ fail:
+  return false;
+}
+
+// Complete requests that are done without waiting.
+void SdVolume::asyncPoll() {
+  while (asyncCount_ && sdCard_->poll()) asyncRetire();
+}
+
+// Complete the oldest request.  A buffer that failed to write is marked
+// dirty so the next sync writes it again, a failed read empties the
+// read-ahead buffer.
+bool SdVolume::asyncRetire() {
+  uint8_t way = asyncWay_[asyncHead_];
+  bool rtn = sdCard_->complete();
+  asyncHead_ = (asyncHead_ + 1) % ASYNC_SD_QUEUE;
+  asyncCount_--;
+#if READ_AHEAD_BLOCKS
+  if (way & ASYNC_RING) {
+    way &= ~ASYNC_RING;
+    raBusy_[way] = false;
+    if (!rtn) raBlockNumber_[way] = 0XFFFFFFFF;
+    return rtn;
+  }
+#endif  // READ_AHEAD_BLOCKS
+  cacheStatus_[way] &= ~CACHE_STATUS_BUSY;
+  if (!rtn && cacheBlockNumber_[way] != 0XFFFFFFFF) {
+    cacheStatus_[way] |= CACHE_STATUS_DIRTY;
+  }
+  return rtn;
+}
+
+// Complete all requests, false if any failed.
+bool SdVolume::asyncWait() {
+  bool rtn = true;
+  while (asyncCount_) {
+    if (!asyncRetire()) rtn = false;
+  }
+  return rtn;
+}
+#endif  // ASYNC_SD_QUEUE
+
+// Keep a data block in the cache until cacheUnpin().  At least one data
+// buffer is never pinned so nothing is pinned with one data buffer.
+bool SdVolume::cachePin(uint32_t blockNumber) {
+  uint8_t first;
+  uint8_t last;
+  uint8_t pinned = 0;
+  cacheSet(0, &first, &last);
+  for (uint8_t i = first; i < last; i++) {
+    if (cachePinCount_[i] && cacheBlockNumber_[i] != blockNumber) pinned++;
+  }
+  if ((pinned + 1) >= (last - first)) return false;
+  if (!cacheFetch(blockNumber, CACHE_FOR_READ)) return false;
+  if (cachePinCount_[cacheCurrent_] != 0XFF) cachePinCount_[cacheCurrent_]++;
+  return true;
+}
+
+void SdVolume::cacheUnpin(uint32_t blockNumber) {
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) {
+    if (cacheBlockNumber_[i] == blockNumber && cachePinCount_[i]) {
+      cachePinCount_[i]--;
+    }
+  }
+}
+
+bool SdVolume::init(Sd2Card* dev, uint8_t part) {
+  uint32_t totalBlocks;
+  uint32_t volumeStartBlock = 0;
+  uint16_t journalBlocks;
+  pfs_boot_t* pbs;
+  cache_t* pc;
+  sdCard_ = dev;
+  allocSearchStart_ = 2;
+  infoBlock_ = 0;
+  freeCount_ = -1;
+  infoDirty_ = false;
+  infoStale_ = true;
+  mirrorStale_ = false;
+#if ERASE_FREED_CLUSTERS
+  eraseOnFree_ = false;
+  eraseCount_ = 0;
+#endif  // ERASE_FREED_CLUSTERS
+  cachePfsOffset_ = 0;
+  cacheCurrent_ = CACHE_PFS_WAYS;
+#if PFS_WINDOW_ENTRIES
+  pfsWindowFirst_[0] = pfsWindowFirst_[1] = 0XFFFFFFFF;
+#endif  // PFS_WINDOW_ENTRIES
+#if PFS_JOURNAL
+  journalBlocks_ = 0;
+#endif  // PFS_JOURNAL
+#if READ_AHEAD_BLOCKS
+  raHead_ = 0;
+  raCount_ = 0;
+  raStream_ = 0XFFFFFFFF;
+#if ASYNC_SD_QUEUE
+  for (uint8_t i = 0; i < READ_AHEAD_BLOCKS; i++) raBusy_[i] = false;
+#endif  // ASYNC_SD_QUEUE
+#endif  // READ_AHEAD_BLOCKS
+#if ASYNC_SD_QUEUE
+  asyncHead_ = 0;
+  asyncCount_ = 0;
+#endif  // ASYNC_SD_QUEUE
+#if DIR_HASH_SIZE
+  dirHashCluster_ = 0;
+#endif  // DIR_HASH_SIZE
+  for (uint8_t i = 0; i < CACHE_WAYS; i++) {
+    cacheBlockNumber_[i] = 0XFFFFFFFF;
+    cacheStatus_[i] = 0;
+    cachePinCount_[i] = 0;
+#if PFS_JOURNAL
+    cacheLogHi_[i] = 0;
+#endif  // PFS_JOURNAL
+  }
+  if (part) {
+    if (part > 4) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    pc = cacheFetch(volumeStartBlock, CACHE_FOR_READ);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    part_t* p = &pc->mbr.part[part-1];
+    if ((p->boot & 0X7F) !=0  || p->totalSectors < 100 || p->firstSector == 0) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    volumeStartBlock = p->firstSector;
+  }
+  pc = cacheFetch(volumeStartBlock, CACHE_FOR_READ);
+  if (!pc) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  pbs = &(pc->pbs);
+  if (pbs->bytesPerSector != 512) {
+      DBG_FAIL_MACRO;
+      goto fail;
+  }
+  // only one mirror of the table is kept up to date
+  pfsCount_ = pbs->pfsCount ? pbs->pfsCount : 1;
+  if (pfsCount_ > 2) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  blocksPerCluster_ = pbs->sectorsPerCluster;
+  
+  // determine shift that is same as multiply by blocksPerCluster_
+  clusterSizeShift_ = 0;
+  while (blocksPerCluster_ != (1 << clusterSizeShift_)) {
+    // error if not power of 2
+    if (clusterSizeShift_++ > 7) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+  }
+
+  // images made before the table could span blocks have zero here
+  sectorsPerPfs_ = pbs->sectorsPerFat ? pbs->sectorsPerFat : 1;
+
+  if (pfsCount_ > 1) cachePfsOffset_ = sectorsPerPfs_;
+  // optional PFS_info block follows the boot block, the table follows it
+  if (pbs->pfsInfo) infoBlock_ = volumeStartBlock + pbs->pfsInfo;
+  pfsStartBlock_ = volumeStartBlock + 1 + pbs->pfsInfo;
+
+  // root directory is the cluster chain at pfsRootCluster
+  rootDirStart_ = pbs->pfsRootCluster;
+  rootClusterCount_ = 0;
+
+  // data start for PFS
+  dataStartBlock_ = pfsStartBlock_ + pfsCount_ * sectorsPerPfs_
+                    + ((32 * pbs->rootDirEntryCount + 511)/512);
+
+  // the journal, if any, is just before the data
+  journalBlocks = pbs->journalBlocks;
+  dataStartBlock_ += journalBlocks;
+  // the volume is only up to date after the journal is replayed
+  if (journalBlocks && !PFS_JOURNAL) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+  
+  totalBlocks = pbs->totalSectors;
+  
+  // total data blocks
+  clusterCount_ = totalBlocks - (dataStartBlock_ - volumeStartBlock);
+
+  // divide by cluster size to get cluster count
+  clusterCount_ >>= clusterSizeShift_;
+
+  // clusters without a table entry can't be used
+  if (clusterCount_ > 128*sectorsPerPfs_ - 2) {
+    clusterCount_ = 128*sectorsPerPfs_ - 2;
+  }
+  rootDirEntryCount_ = pbs->rootDirEntryCount;
+
+  if (infoBlock_) {
+    pc = cacheFetch(infoBlock_, CACHE_FOR_READ);
+    if (!pc) {
+      DBG_FAIL_MACRO;
+      goto fail;
+    }
+    // trust the saved counts if they are sane, else rescan when needed.
+    // The count is 0XFFFFFFFF if the volume was changed and not synced.
+    pfs_info_t* fsi = &pc->fsinfo;
+    if (fsi->leadSignature == FSINFO_LEAD_SIG
+      && fsi->structSignature == FSINFO_STRUCT_SIG) {
+      if (fsi->freeCount <= clusterCount_) {
+        freeCount_ = fsi->freeCount;
+        infoStale_ = false;
+      }
+      if (fsi->nextFree >= 2 && fsi->nextFree <= (clusterCount_ + 1)) {
+        allocSearchStart_ = fsi->nextFree;
+      }
+      // power was lost before the mirror was brought up to date
+      mirrorStale_ = cachePfsOffset_ && !ENABLED_READ_ONLY
+                     && fsi->mirrorState == PFS_MIRROR_STALE;
+    }
+  }
+#if PFS_MIRROR_MAP_SIZE
+  // defer mirror writes if PFS_info can hold the marker
+  memset(mirrorMap_, 0, sizeof(mirrorMap_));
+  mirrorEvicted_ = false;
+  mirrorShift_ = 0;
+  while (((sectorsPerPfs_ - 1) >> mirrorShift_) >= 8*PFS_MIRROR_MAP_SIZE) {
+    mirrorShift_++;
+  }
+  // with a journal table blocks are seldom written in place
+  mirrorBase_ = cachePfsOffset_ && infoBlock_ && !journalBlocks
+                ? pfsStartBlock_ : 0;
+#endif  // PFS_MIRROR_MAP_SIZE
+#if PFS_JOURNAL
+  if (journalBlocks
+    && !journalInit(dataStartBlock_ - journalBlocks, journalBlocks)) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#endif  // PFS_JOURNAL
+  if (mirrorStale_ && !(mirrorSync(true) && cacheSync())) {
+    DBG_FAIL_MACRO;
+    goto fail;
+  }
+#if USE_PFS_BITMAP
+  // fall back to searching the table if there is no memory for the bitmap
+  bitmapInit();
+#endif  // USE_PFS_BITMAP
+  return true;
+
+ fail:
+  return false;
 }
\ No newline at end of file
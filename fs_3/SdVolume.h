@@ -1,143 +1,352 @@
-/* Arduino PFS Library
- * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
- *
- * This file is part of the Arduino PFS Library
- *
- * This Library is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This Library is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with the Arduino PFS Library.  If not, see
- * <http://www.gnu.org/licenses/>.
- */
-/*
- *Creditos: https://github.com/frasermac/sdfatlib
- */
-#ifndef SdVolume_h
-#define SdVolume_h
-
-#include <SdPfsConfig.h>
-#include <Sd2Card.h>
-#include <SdPfsStructs.h>
-
-union cache_t {
-           /** Used to access cached file data blocks. */
-  uint8_t  data[512];
-           /** Used to access cached directory entries. */
-  dir_t    dir[8];
-           /** Used to access cached FAT32 entries. */
-  uint32_t fat32[128];
-           /** Used to access a cached Master Boot Record. */
-  mbr_t    mbr;
-           /** Used to access to a cached PFS boot sector. */
-  pfs_boot_t pbs;
-           /** Used to access to a cached PFS FSINFO sector. */
-  pfs_info_t fsinfo;
-};
-
-class SdVolume {
- public:
-  SdVolume() :allocSearchStart_(2){}
-
-  cache_t* cacheClear() {
-    if (!cacheSync()) return 0;
-    cacheBlockNumber_ = 0XFFFFFFFF;
-    return &cacheBuffer_;
-  }
-
-  bool init(Sd2Card* dev) { return init(dev, 1) ? true : init(dev, 0);}
-  bool init(Sd2Card* dev, uint8_t part); //ya
-
-  // inline functions that return volume info
-  /** \return The volume's cluster size in blocks. */
-  uint8_t blocksPerCluster() const {return blocksPerCluster_;} //ya
-  /** \return The total number of clusters in the volume. */
-  uint32_t clusterCount() const {return clusterCount_;} //ya
-  /** \return The shift count required to multiply by blocksPerCluster. */
-  uint8_t clusterSizeShift() const {return clusterSizeShift_;} //ya
-  /** \return The logical block number for the start of file data. */
-  uint32_t dataStartBlock() const {return dataStartBlock_;} //ya
-  /** \return The logical block number for the start of the first PFS. */
-  uint32_t pfsStartBlock() const {return pfsStartBlock_;} //ya
-  int32_t freeClusterCount();
-  /** \return The number of entries in the root directory for FAT16 volumes. */
-  uint32_t rootDirEntryCount() const {return rootDirEntryCount_;} //ya
-  /** \return The logical block number for the start of the root directory
-       on FAT16 volumes or the first cluster number on FAT32 volumes. */
-  uint32_t rootDirStart() const {return rootDirStart_;} //ya
-
-  Sd2Card* sdCard() {return sdCard_;} //ya
-
-  bool dbgPfs(uint32_t n, uint32_t* v) {return pfsGet(n, v);} //ya
-
-  static const uint8_t CACHE_STATUS_DIRTY = 1;
-  static const uint8_t CACHE_STATUS_PFS_BLOCK = 2;
-  static const uint8_t CACHE_STATUS_MASK
-     = CACHE_STATUS_DIRTY | CACHE_STATUS_PFS_BLOCK;
-  static const uint8_t CACHE_OPTION_NO_READ = 4;
-  // value for option argument in cacheFetch to indicate read from cache
-  static uint8_t const CACHE_FOR_READ = 0;
-  // value for option argument in cacheFetch to indicate write to cache
-  static uint8_t const CACHE_FOR_WRITE = CACHE_STATUS_DIRTY;
-  // reserve cache block with no read
-  static uint8_t const CACHE_RESERVE_FOR_WRITE
-     = CACHE_STATUS_DIRTY | CACHE_OPTION_NO_READ;
-
-private:
-  friend class SdBaseFile;      // Allow SdBaseFile access to SdVolume private data.
-
-  uint8_t pfsCount_;            // number of PFSs on volume
-  uint16_t rootDirEntryMax_;    // maximum number of entries in PFS root dir
-  uint16_t rootDirEntryCount_;    // number of entries in PFS root dir
-  uint32_t sectorsPerPfs_;      // PFS size in blocks
-  uint32_t pfsStartBlock_;      // start block for first PFS
-  uint8_t blocksPerCluster_;    // cluster size in blocks
-  uint8_t clusterSizeShift_;    // shift to convert cluster count to block count (always 0 for us)
-  uint32_t rootDirStart_;       // root start block for PFS
-  uint32_t dataStartBlock_;     // first data block number
-  uint32_t clusterCount_;       // clusters in one PFS
-  uint32_t allocSearchStart_;   // start cluster for alloc search
-
-
-  static cache_t cacheBuffer_;        // 512 byte cache for device blocks
-  static uint32_t cacheBlockNumber_;  // Logical number of block in the cache
-  static uint32_t cachePfsOffset_;    // offset for mirrored PFS
-  static uint8_t cacheStatus_;        // status of cache block
-  static Sd2Card* sdCard_;            // Sd2Card object for cache
-  
-  
-  static bool cacheSync(); //ya
-  static cache_t* cacheFetchPfs(uint32_t blockNumber, uint8_t options); //ya
-  static cache_t* cacheFetch(uint32_t blockNumber, uint8_t options); //ya
-  static void cacheInvalidate(); //ya
-  static bool cacheWriteData(); //ya
-  static bool cacheWritePfs(); //ya
-
-  bool pfsGet(uint32_t cluster, uint32_t* value); //ya
-  bool pfsPut(uint32_t cluster, uint32_t value); //ya
-  bool pfsPutEOC(uint32_t cluster) {return pfsPut(cluster, 0x0FFFFFFF);} //ya
-  uint32_t clusterStartBlock(uint32_t cluster) const; //ya
-  uint8_t blockOfCluster(uint32_t position) const {return (position >> 9) & (blocksPerCluster_ - 1);} //ya
-  bool freeChain(uint32_t cluster); //ya
-  bool isEOC(uint32_t cluster) const {return  cluster >= PFSEOC_MIN;}
-  cache_t *cacheAddress() {return &cacheBuffer_;} //ya
-  uint32_t cacheBlockNumber() {return cacheBlockNumber_;} //ya
-
-  bool allocContiguous(uint32_t count, uint32_t* curCluster);
-
-  bool readBlock(uint32_t block, uint8_t* dst) {
-    return sdCard_->readBlock(block, dst);
-  } //ya
-  bool writeBlock(uint32_t block, const uint8_t* dst) {
-    return sdCard_->writeBlock(block, dst);
-  } //ya
-};
-
+/* Arduino PFS Library
+ * Copyright (C) 2013 by Enrique Urbina, Moises Martinez and Néstor Bermúdez
+ *
+ * This file is part of the Arduino PFS Library
+ *
+ * This Library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This Library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Arduino PFS Library.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/*
+ *Creditos: https://github.com/frasermac/sdfatlib
+ */
+#ifndef SdVolume_h
+#define SdVolume_h
+
+#include <SdPfsConfig.h>
+#include <Sd2Card.h>
+#include <SdPfsStructs.h>
+#if USE_PFS_BITMAP
+#include <stdlib.h>
+#endif  // USE_PFS_BITMAP
+
+union cache_t {
+           /** Used to access cached file data blocks. */
+  uint8_t  data[512];
+           /** Used to access cached directory entries. */
+  dir_t    dir[16];
+           /** Used to access cached FAT32 entries. */
+  uint32_t fat32[128];
+           /** Used to access a cached Master Boot Record. */
+  mbr_t    mbr;
+           /** Used to access to a cached PFS boot sector. */
+  pfs_boot_t pbs;
+           /** Used to access to a cached PFS FSINFO sector. */
+  pfs_info_t fsinfo;
+};
+/** cache buffers used for PFS table blocks only */
+uint8_t const CACHE_PFS_WAYS = USE_SEPARATE_PFS_CACHE ? CACHE_PFS_BLOCKS : 0;
+/** total number of cache buffers */
+uint8_t const CACHE_WAYS = CACHE_DATA_BLOCKS + CACHE_PFS_WAYS;
+/** journal blocks of the largest transaction, all buffers logged whole,
+ * a smaller journal has some transactions written in place */
+uint16_t const JOURNAL_MAX_BLOCKS = (sizeof(pfs_journal_t)
+  + CACHE_WAYS*(sizeof(pfs_journal_record_t) + 512) + 511)/512;
+
+class SdVolume {
+ public:
+  SdVolume() :allocSearchStart_(2) {
+#if ERASE_FREED_CLUSTERS
+    eraseOnFree_ = false;
+    eraseCount_ = 0;
+#endif  // ERASE_FREED_CLUSTERS
+#if USE_PFS_BITMAP
+    bitmap_ = 0;
+#endif  // USE_PFS_BITMAP
+#if DIR_HASH_SIZE
+    dirHashCluster_ = 0;
+#endif  // DIR_HASH_SIZE
+  }
+#if USE_PFS_BITMAP
+  ~SdVolume() {free(bitmap_);}
+#endif  // USE_PFS_BITMAP
+
+  cache_t* cacheClear() {
+    if (!cacheSync()) return 0;
+    cacheBlockNumber_[cacheCurrent_] = 0XFFFFFFFF;
+    return &cacheBuffer_[cacheCurrent_];
+  }
+
+  bool init(Sd2Card* dev) { return init(dev, 1) ? true : init(dev, 0);}
+  bool init(Sd2Card* dev, uint8_t part); //ya
+
+  // inline functions that return volume info
+  /** \return The volume's cluster size in blocks. */
+  uint8_t blocksPerCluster() const {return blocksPerCluster_;} //ya
+  /** \return The total number of clusters in the volume. */
+  uint32_t clusterCount() const {return clusterCount_;} //ya
+  /** \return The shift count required to multiply by blocksPerCluster. */
+  uint8_t clusterSizeShift() const {return clusterSizeShift_;} //ya
+  /** \return The logical block number for the start of file data. */
+  uint32_t dataStartBlock() const {return dataStartBlock_;} //ya
+  /** \return The logical block number for the start of the first PFS. */
+  uint32_t pfsStartBlock() const {return pfsStartBlock_;} //ya
+#if ERASE_FREED_CLUSTERS
+  bool eraseOnFree(bool enable);
+#endif  // ERASE_FREED_CLUSTERS
+  int32_t freeClusterCount();
+  bool sync();
+  /** \return The number of entries in the root directory for FAT16 volumes. */
+  uint32_t rootDirEntryCount() const {return rootDirEntryCount_;} //ya
+  /** \return The logical block number for the start of the root directory
+       on FAT16 volumes or the first cluster number on FAT32 volumes. */
+  uint32_t rootDirStart() const {return rootDirStart_;} //ya
+
+  Sd2Card* sdCard() {return sdCard_;} //ya
+
+  bool dbgPfs(uint32_t n, uint32_t* v) {return pfsGet(n, v);} //ya
+
+  static const uint8_t CACHE_STATUS_DIRTY = 1;
+  static const uint8_t CACHE_STATUS_PFS_BLOCK = 2;
+  static const uint8_t CACHE_STATUS_MASK
+     = CACHE_STATUS_DIRTY | CACHE_STATUS_PFS_BLOCK;
+  static const uint8_t CACHE_OPTION_NO_READ = 4;
+  // buffer is being written by an asynchronous request, not an option
+  static const uint8_t CACHE_STATUS_BUSY = 8;
+  // changes to the buffer are logged in the journal, as an option the
+  // caller logs the bytes it changes with cacheLog()
+  static const uint8_t CACHE_STATUS_LOGGED = 0X10;
+  // value for option argument in cacheFetch to indicate read from cache
+  static uint8_t const CACHE_FOR_READ = 0;
+  // value for option argument in cacheFetch to indicate write to cache
+  static uint8_t const CACHE_FOR_WRITE = CACHE_STATUS_DIRTY;
+  // reserve cache block with no read
+  static uint8_t const CACHE_RESERVE_FOR_WRITE
+     = CACHE_STATUS_DIRTY | CACHE_OPTION_NO_READ;
+  // value for option argument in cacheFetch to change table or directory
+  static uint8_t const CACHE_FOR_LOG
+     = CACHE_STATUS_DIRTY | CACHE_STATUS_LOGGED;
+
+private:
+  friend class SdBaseFile;      // Allow SdBaseFile access to SdVolume private data.
+  friend class SdPfsCheck;      // checks and repairs the table and entries
+
+  uint8_t pfsCount_;            // number of PFSs on volume
+  uint16_t rootDirEntryMax_;    // maximum number of entries in PFS root dir
+  uint16_t rootDirEntryCount_;    // number of entries in PFS root dir
+  uint32_t sectorsPerPfs_;      // PFS size in blocks
+  uint32_t pfsStartBlock_;      // start block for first PFS
+  uint8_t blocksPerCluster_;    // cluster size in blocks
+  uint8_t clusterSizeShift_;    // shift to convert cluster count to block count (always 0 for us)
+  uint32_t rootDirStart_;       // first cluster of the PFS root directory
+  uint32_t rootClusterCount_;   // clusters in root directory, 0 if not known
+  uint32_t dataStartBlock_;     // first data block number
+  uint32_t clusterCount_;       // clusters in one PFS
+  uint32_t allocSearchStart_;   // start cluster for alloc search
+  uint32_t infoBlock_;          // block of PFS_info, zero if none
+  int32_t freeCount_;           // free clusters, -1 if not known
+  bool infoDirty_;              // PFS_info needs to be written
+  bool infoStale_;              // PFS_info on the card has no free count
+#if ERASE_FREED_CLUSTERS
+  bool eraseOnFree_;            // erase clusters freed by freeChain()
+  uint8_t eraseMask_;           // erase sector size - 1, zero if single block
+  uint8_t eraseCount_;          // freed runs waiting for the next sync
+  uint32_t eraseFirst_[ERASE_FREED_CLUSTERS];  // first cluster of each run
+  uint32_t eraseLast_[ERASE_FREED_CLUSTERS];   // last cluster of each run
+#endif  // ERASE_FREED_CLUSTERS
+#if USE_PFS_BITMAP
+  uint32_t* bitmap_;            // one bit per cluster, set if in use
+#endif  // USE_PFS_BITMAP
+#if DIR_HASH_SIZE
+  uint32_t dirHashCluster_;     // first cluster of hashed directory, 0 if none
+  bool dirHashFull_;            // directory has too many names to hash
+  uint16_t dirHashUsed_;        // slots in use, removed names included
+  uint16_t dirHashRemoved_;     // slots of removed names
+  uint32_t dirHashFree_;        // no free entry before this entry
+  uint16_t dirHash_[DIR_HASH_SIZE];  // entry number + 1, zero if empty
+#endif  // DIR_HASH_SIZE
+
+
+  // the cache is CACHE_WAYS buffers, the first CACHE_PFS_WAYS are
+  // reserved for PFS table blocks
+  static cache_t cacheBuffer_[CACHE_WAYS];        // 512 byte buffers
+  static uint32_t cacheBlockNumber_[CACHE_WAYS];  // block in each buffer
+  static uint32_t cacheUse_[CACHE_WAYS];          // time of last use for LRU
+  static uint8_t cacheStatus_[CACHE_WAYS];        // status of each buffer
+  static uint8_t cachePinCount_[CACHE_WAYS];      // pins held on each buffer
+  static uint32_t cacheUseCount_;     // clock for cacheUse_
+  static uint8_t cacheCurrent_;       // buffer of the last cacheFetch
+  static uint32_t cachePfsOffset_;    // offset for mirrored PFS
+#if PFS_WINDOW_ENTRIES
+  // table entries [pfsWindowFirst_[w], pfsWindowFirst_[w] +
+  // PFS_WINDOW_ENTRIES) are in pfsWindow_[w], 0XFFFFFFFF if empty
+  static uint32_t pfsWindow_[2][PFS_WINDOW_ENTRIES];
+  static uint32_t pfsWindowFirst_[2];
+  static uint8_t pfsWindowLast_;      // window of the last lookup
+#endif  // PFS_WINDOW_ENTRIES
+  static bool mirrorStale_;           // PFS_info on the card is marked stale
+#if PFS_MIRROR_MAP_SIZE
+  // table blocks evicted without writing the mirror, one bit per group of
+  // 1 << mirrorShift_ blocks.  Mirror writes are deferred if mirrorBase_,
+  // the first table block, is nonzero.  PFS_info is the block before it.
+  static uint8_t mirrorMap_[PFS_MIRROR_MAP_SIZE];
+  static uint8_t mirrorShift_;
+  static uint32_t mirrorBase_;
+  static bool mirrorEvicted_;         // a table block was evicted since sync
+#endif  // PFS_MIRROR_MAP_SIZE
+#if PFS_JOURNAL
+  // bytes [cacheLogLo_[i], cacheLogHi_[i]) of buffer i are changed since
+  // the last commit, none if cacheLogHi_[i] is zero
+  static uint16_t cacheLogLo_[CACHE_WAYS];
+  static uint16_t cacheLogHi_[CACHE_WAYS];
+  static cache_t journalBuffer_;      // a block of a transaction
+  static uint32_t journalBufferBlock_;  // block in journalBuffer_
+  static uint32_t journalStart_;      // first block of the journal
+  static uint16_t journalBlocks_;     // journal size, zero if none
+  static uint16_t journalHead_;       // journal block of the next commit
+  static uint32_t journalSeq_;        // sequence of the next commit
+  // data area blocks logged since the journal was started
+  static uint32_t journalDataLo_;
+  static uint32_t journalDataHi_;
+  static bool journalRevoke_;         // some of them are in freed clusters
+  static SdVolume* journalVolume_;    // volume of the free count
+#endif  // PFS_JOURNAL
+  static Sd2Card* sdCard_;            // Sd2Card object for cache
+#if READ_AHEAD_BLOCKS
+  static cache_t raBuffer_[READ_AHEAD_BLOCKS];        // read-ahead ring
+  static uint32_t raBlockNumber_[READ_AHEAD_BLOCKS];  // block in each buffer
+  static uint8_t raHead_;             // oldest buffer in the ring
+  static uint8_t raCount_;            // buffers in the ring
+  static uint32_t raStream_;          // next block of open CMD18
+#if ASYNC_SD_QUEUE
+  static bool raBusy_[READ_AHEAD_BLOCKS];  // read of buffer not completed
+#endif  // ASYNC_SD_QUEUE
+#endif  // READ_AHEAD_BLOCKS
+#if ASYNC_SD_QUEUE
+  // buffer of each queued card request, a cache index or ASYNC_RING | index
+  // of a read-ahead buffer
+  static const uint8_t ASYNC_RING = 0X80;
+  static uint8_t asyncWay_[ASYNC_SD_QUEUE];
+  static uint8_t asyncHead_;          // oldest request
+  static uint8_t asyncCount_;         // requests queued on the card
+#endif  // ASYNC_SD_QUEUE
+
+
+  static bool cacheSync(); //ya
+  static cache_t* cacheFetchPfs(uint32_t blockNumber, uint8_t options); //ya
+  static cache_t* cacheFetch(uint32_t blockNumber, uint8_t options); //ya
+  static bool cacheHas(uint32_t blockNumber, uint32_t count = 1);
+  static void cacheInvalidate(uint32_t blockNumber, uint32_t count = 1);
+  static bool cachePin(uint32_t blockNumber);
+  static void cacheUnpin(uint32_t blockNumber);
+  static bool cacheWriteData(); //ya
+  static bool cacheWritePfs(); //ya
+  static bool cacheWrite(uint8_t i);
+#if PFS_MIRROR_MAP_SIZE
+  static bool cacheEvict(uint8_t i);
+#else  // PFS_MIRROR_MAP_SIZE
+  static bool cacheEvict(uint8_t i) {return cacheWrite(i);}
+#endif  // PFS_MIRROR_MAP_SIZE
+  static uint8_t cacheVictim(uint8_t first, uint8_t last);
+#if PFS_JOURNAL
+  static void cacheLog(uint8_t i, uint16_t offset, uint16_t count);
+  static bool journalCommit();
+  static void journalFill(uint16_t k, uint16_t* crc);
+  bool journalInit(uint32_t start, uint16_t blocks);
+  static bool journalLoad(uint16_t b);
+  static bool journalRead(uint32_t pos, void* dst, uint16_t count);
+  void journalFree(uint32_t cluster, uint32_t count);
+#else  // PFS_JOURNAL
+  static void cacheLog(uint8_t, uint16_t, uint16_t) {}
+  void journalFree(uint32_t, uint32_t) {}
+#endif  // PFS_JOURNAL
+#if READ_AHEAD_BLOCKS
+  static bool readAheadAdd(uint32_t blockNumber);
+  static bool readAheadCopy(uint32_t blockNumber, uint8_t* dst);
+  static void readAheadInvalidate(uint32_t blockNumber, uint32_t count);
+  static bool readAheadStop();
+#else  // READ_AHEAD_BLOCKS
+  static void readAheadInvalidate(uint32_t, uint32_t) {}
+  static bool readAheadStop() {return true;}
+#endif  // READ_AHEAD_BLOCKS
+#if ASYNC_SD_QUEUE
+  static bool asyncBegin(uint32_t blockNumber, uint8_t way);
+  static void asyncPoll();
+  static bool asyncRetire();
+  static bool asyncWait();
+#else  // ASYNC_SD_QUEUE
+  static bool asyncWait() {return true;}
+#endif  // ASYNC_SD_QUEUE
+  // finish background card work before a card command
+  static bool cardIdle() {return asyncWait() && readAheadStop();}
+
+  bool pfsGet(uint32_t cluster, uint32_t* value, bool forWrite = false); //ya
+  bool pfsPut(uint32_t cluster, uint32_t value); //ya
+  bool pfsPutEOC(uint32_t cluster) {return pfsPut(cluster, 0x0FFFFFFF);} //ya
+  bool pfsPutRange(uint32_t cluster, uint32_t count, uint32_t value);
+  bool pfsFreeRange(uint32_t cluster, uint32_t count);
+  cache_t* pfsFetchRange(uint32_t cluster, uint32_t count, uint16_t* n);
+#if PFS_WINDOW_ENTRIES
+  uint32_t* pfsWindowFetch(uint32_t cluster);
+  static void pfsWindowPut(uint32_t cluster, uint32_t count, uint32_t value);
+#else  // PFS_WINDOW_ENTRIES
+  static void pfsWindowPut(uint32_t, uint32_t, uint32_t) {}
+#endif  // PFS_WINDOW_ENTRIES
+  bool infoMarkStale();
+  bool mirrorSync(bool all);
+  uint32_t clusterStartBlock(uint32_t cluster) const; //ya
+  uint8_t blockOfCluster(uint32_t position) const {return (position >> 9) & (blocksPerCluster_ - 1);} //ya
+  bool freeChain(uint32_t cluster, uint32_t count = 0); //ya
+#if ERASE_FREED_CLUSTERS
+  void eraseCancel(uint32_t first, uint32_t count);
+  void eraseQueue(uint32_t first, uint32_t last);
+  void eraseQueued();
+  void eraseRun(uint32_t first, uint32_t last);
+#else  // ERASE_FREED_CLUSTERS
+  void eraseCancel(uint32_t, uint32_t) {}
+  void eraseQueued() {}
+#endif  // ERASE_FREED_CLUSTERS
+  void freeCountAdd(int32_t change) {
+    if (freeCount_ >= 0) freeCount_ += change;
+    infoDirty_ = true;
+  }
+  bool isEOC(uint32_t cluster) const {return  cluster >= PFSEOC_MIN;}
+  cache_t *cacheAddress() {return &cacheBuffer_[cacheCurrent_];} //ya
+  uint32_t cacheBlockNumber() {return cacheBlockNumber_[cacheCurrent_];} //ya
+
+  bool allocContiguous(uint32_t count, uint32_t* curCluster);
+#if USE_PFS_BITMAP
+  bool bitmapInit();
+  uint32_t bitmapFind(uint32_t start, uint32_t count);
+  void bitmapPutRange(uint32_t cluster, uint32_t count, bool used);
+  void bitmapPut(uint32_t cluster, bool used) {
+    if (used) {
+      bitmap_[cluster >> 5] |= 1UL << (cluster & 31);
+    } else {
+      bitmap_[cluster >> 5] &= ~(1UL << (cluster & 31));
+    }
+  }
+#endif  // USE_PFS_BITMAP
+
+#if DIR_HASH_SIZE
+  // dirHash_ value of the slot of a removed name
+  static uint16_t const DIR_HASH_REMOVED = 0XFFFF;
+  void dirHashClear(uint32_t cluster);
+  bool dirHashed(uint32_t cluster) {
+    return cluster && cluster == dirHashCluster_ && !dirHashFull_;
+  }
+  void dirHashInsert(const uint8_t* name, uint32_t entry);
+  void dirHashRemove(const uint8_t* name, uint32_t entry);
+  static uint16_t dirHashSlot(const uint8_t* name);
+#endif  // DIR_HASH_SIZE
+
+  bool readBlock(uint32_t block, uint8_t* dst) {
+    return cardIdle() && sdCard_->readBlock(block, dst);
+  } //ya
+  bool writeBlock(uint32_t block, const uint8_t* dst) {
+    readAheadInvalidate(block, 1);
+    return cardIdle() && sdCard_->writeBlock(block, dst);
+  } //ya
+};
+
  #endif // SdVolume_h
\ No newline at end of file